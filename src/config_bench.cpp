@@ -0,0 +1,156 @@
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <cctype>
+#include <cstdint>
+#ifdef _MSC_VER
+#include <BaseTsd.h>
+typedef SSIZE_T ssize_t;
+#endif
+
+#define SDL_MAIN_HANDLED
+#include <SDL.h>
+
+#include "aids.hpp"
+using namespace aids;
+
+#include "config_common.cpp"
+
+// NOTE: what config_index_by_name used to be before the perfect hash,
+// for comparison
+ssize_t config_index_by_name_linear(String_View name)
+{
+    for (size_t i = 0; i < CONFIG_VAR_CAPACITY; ++i) {
+        if (config_names[i] == name) return (ssize_t) i;
+    }
+    return -1;
+}
+
+// NOTE: the file with its lines in the reverse order, so every
+// reference that was backward becomes forward and the other way around
+void write_reordered_config(const char *file_path, const char *reordered_path)
+{
+    FILE *f = fopen(reordered_path, "wb");
+    if (!f) {
+        println(stderr, "Could not open file `", reordered_path, "`: ", strerror(errno));
+        exit(1);
+    }
+    size_t end = config_file_buffer_size;
+    while (end > 0) {
+        size_t begin = end - 1;
+        while (begin > 0 && config_file_buffer[begin - 1] != '\n') {
+            begin -= 1;
+        }
+        fwrite(config_file_buffer + begin, 1, end - begin, f);
+        if (config_file_buffer[end - 1] != '\n') {
+            fputc('\n', f);
+        }
+        end = begin;
+    }
+    if (fclose(f) != 0) {
+        println(stderr, "Could not write file `", reordered_path, "` for `", file_path, "`: ", strerror(errno));
+        exit(1);
+    }
+}
+
+bool config_values_equal(const Config_Value *a, const Config_Value *b)
+{
+    for (size_t i = 0; i < CONFIG_VAR_CAPACITY; ++i) {
+        switch (config_types[i]) {
+        case CONFIG_TYPE_INT: if (a[i].int_value != b[i].int_value) return false; break;
+        case CONFIG_TYPE_FLOAT: if (a[i].float_value != b[i].float_value) return false; break;
+        case CONFIG_TYPE_COLOR: {
+            if (a[i].color_value.r != b[i].color_value.r ||
+                a[i].color_value.g != b[i].color_value.g ||
+                a[i].color_value.b != b[i].color_value.b ||
+                a[i].color_value.a != b[i].color_value.a) return false;
+        } break;
+        case CONFIG_TYPE_STRING: if (a[i].string_value != b[i].string_value) return false; break;
+        case CONFIG_TYPE_UNKNOWN: break;
+        }
+    }
+    return true;
+}
+
+Config_Value incremental_values[CONFIG_VAR_CAPACITY] = {};
+
+// NOTE: reloads the file incrementally on top of whatever was loaded
+// before and compares the result with a full reload of the same file
+bool incremental_reload_matches_full(const char *file_path)
+{
+    auto result = reload_config_file(file_path);
+    if (result.is_error) {
+        println(stderr, file_path, ":", result.line, ": ", result.message);
+        exit(1);
+    }
+    memcpy(incremental_values, config_values, sizeof(incremental_values));
+
+    config_needs_full_reload = true;
+    result = reload_config_file(file_path);
+    if (result.is_error) {
+        println(stderr, file_path, ":", result.line, ": ", result.message);
+        exit(1);
+    }
+    return config_values_equal(incremental_values, config_values);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        println(stderr, "Usage: ./config_bench <config.var> [iterations]");
+        exit(1);
+    }
+
+    const char *file_path = argv[1];
+    const int iterations = argc >= 3 ? atoi(argv[2]) : 100;
+    const double ms_per_tick = 1000.0 / (double) SDL_GetPerformanceFrequency();
+
+    Uint64 begin = SDL_GetPerformanceCounter();
+    for (int i = 0; i < iterations; ++i) {
+        auto result = reload_config_file(file_path);
+        if (result.is_error) {
+            println(stderr, file_path, ":", result.line, ": ", result.message);
+            exit(1);
+        }
+    }
+    const double reload_ms = (double) (SDL_GetPerformanceCounter() - begin) * ms_per_tick / iterations;
+
+    size_t found = 0;
+    begin = SDL_GetPerformanceCounter();
+    for (int i = 0; i < iterations; ++i) {
+        for (size_t j = 0; j < CONFIG_VAR_CAPACITY; ++j) {
+            found += config_index_by_name(config_names[j]) >= 0;
+        }
+    }
+    const double hash_ms = (double) (SDL_GetPerformanceCounter() - begin) * ms_per_tick / iterations;
+
+    begin = SDL_GetPerformanceCounter();
+    for (int i = 0; i < iterations; ++i) {
+        for (size_t j = 0; j < CONFIG_VAR_CAPACITY; ++j) {
+            found += config_index_by_name_linear(config_names[j]) >= 0;
+        }
+    }
+    const double linear_ms = (double) (SDL_GetPerformanceCounter() - begin) * ms_per_tick / iterations;
+
+    println(stdout, "Variables:                    ", CONFIG_VAR_CAPACITY);
+    println(stdout, "reload_config_file:           ", (float) reload_ms, " ms");
+    println(stdout, "Lookup of every name, hash:   ", (float) hash_ms, " ms");
+    println(stdout, "Lookup of every name, linear: ", (float) linear_ms, " ms");
+    println(stdout, "(found ", found, ")");
+
+    char reordered_path[1024];
+    snprintf(reordered_path, sizeof(reordered_path), "%s.reordered", file_path);
+    write_reordered_config(file_path, reordered_path);
+    const bool reordered_ok = incremental_reload_matches_full(reordered_path);
+    const bool restored_ok = incremental_reload_matches_full(file_path);
+    println(stdout, "Incremental reload after reordering the lines: ",
+            reordered_ok && restored_ok ? "matches the full one" : "DIFFERS from the full one");
+    if (!reordered_ok || !restored_ok) {
+        exit(1);
+    }
+
+    return 0;
+}
@@ -7,7 +7,12 @@ enum Config_Type
     CONFIG_TYPE_STRING,
 };
 
-#include "../config_types.hpp"
+#include "./config_hash.hpp"
+// NOTE: the config_bench points it at the types of a synthetic config
+#ifndef CONFIG_TYPES_HPP
+#define CONFIG_TYPES_HPP "../config_types.hpp"
+#endif
+#include CONFIG_TYPES_HPP
 #include "something_color.hpp"
 
 const char *const VARS_CONF_FILE_PATH = "./assets/vars.conf";
@@ -44,6 +49,73 @@ union Config_Value
 
 Config_Value config_values[CONFIG_VAR_CAPACITY] = {};
 
+// NOTE: what the previous parse saw, so reload_config_file can
+// reapply only the variables whose lines actually changed
+uint64_t config_line_hashes[CONFIG_VAR_CAPACITY] = {};
+bool config_defined[CONFIG_VAR_CAPACITY] = {};
+// NOTE: the variable the value was taken from, -1 for literals
+ssize_t config_references[CONFIG_VAR_CAPACITY] = {};
+// NOTE: the reference was to a variable not seen yet in that parse,
+// so the value is the zero of a full reload and has to be redone even
+// if the line did not change, because the lines around it could have
+// been reordered
+bool config_forward_references[CONFIG_VAR_CAPACITY] = {};
+bool config_seen[CONFIG_VAR_CAPACITY] = {};
+bool config_needs_full_reload = true;
+
+// NOTE: published by reload_config_file for the code that caches
+// something derived from the variables
+bool config_changed[CONFIG_VAR_CAPACITY] = {};
+size_t config_changed_indices[CONFIG_VAR_CAPACITY] = {};
+size_t config_changed_count = 0;
+
+void config_mark_changed(size_t index)
+{
+    if (!config_changed[index]) {
+        config_changed[index] = true;
+        config_changed_indices[config_changed_count++] = index;
+    }
+}
+
+// NOTE: for the code that sets the variables by hand (the `set`
+// command, the console font size keys). The next reload must restore
+// the value from the file even if its line did not change.
+void config_override(size_t index)
+{
+    config_defined[index] = false;
+}
+
+// NOTE: a full reload copies the value of the referenced variable as
+// it is at that line, which is zero for the variables defined later in
+// the file or not at all. Only the references to the lines seen before
+// in the same parse can be reapplied incrementally.
+bool config_is_backward_reference(ssize_t index, ssize_t other_index)
+{
+    if (other_index == index || !config_seen[other_index]) {
+        config_needs_full_reload = true;
+        return false;
+    }
+    return true;
+}
+
+// NOTE: FNV-1a over the type and the value of the line, so editing
+// the comments or the alignment is not a change
+uint64_t config_line_hash(String_View type, String_View value)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < type.count; ++i) {
+        hash ^= (uint8_t) type.data[i];
+        hash *= 1099511628211ull;
+    }
+    hash ^= (uint8_t) '=';
+    hash *= 1099511628211ull;
+    for (size_t i = 0; i < value.count; ++i) {
+        hash ^= (uint8_t) value.data[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
 const size_t CONFIG_FILE_CAPACITY = 1 * 1024 * 1024;
 char config_file_buffer[CONFIG_FILE_CAPACITY];
 size_t config_file_buffer_size = 0;
@@ -184,6 +256,30 @@ Config_Parse_Result parse_config_text(String_View input)
             return parse_failure(config_error_buffer, line_number);
         }
 
+        config_seen[index] = true;
+
+        const uint64_t line_hash = config_line_hash(type, value);
+        const bool unchanged =
+            config_defined[index] &&
+            config_line_hashes[index] == line_hash &&
+            !config_forward_references[index] &&
+            (config_references[index] < 0 ||
+             (config_is_backward_reference(index, config_references[index]) &&
+              !config_changed[config_references[index]]));
+
+        // NOTE: the strings point into config_file_buffer, which now
+        // holds the new text, so they are re-pointed even when they
+        // did not change
+        if (unchanged && actual_config_type != CONFIG_TYPE_STRING) continue;
+
+        config_line_hashes[index] = line_hash;
+        config_defined[index] = true;
+        config_references[index] = -1;
+        config_forward_references[index] = false;
+        if (!unchanged) {
+            config_mark_changed((size_t) index);
+        }
+
         switch (actual_config_type) {
         case CONFIG_TYPE_COLOR: {
             auto x = string_view_as_color(value);
@@ -202,8 +298,10 @@ Config_Parse_Result parse_config_text(String_View input)
                 if (other_variable_result.is_error) {
                     return other_variable_result;
                 }
+                config_forward_references[index] = !config_is_backward_reference(index, other_variable_index);
 
                 config_values[index].color_value = config_values[other_variable_index].color_value;
+                config_references[index] = other_variable_index;
                 continue;
             }
             config_values[index].color_value = x.unwrap;
@@ -226,8 +324,10 @@ Config_Parse_Result parse_config_text(String_View input)
                 if (other_variable_result.is_error) {
                     return other_variable_result;
                 }
+                config_forward_references[index] = !config_is_backward_reference(index, other_variable_index);
 
                 config_values[index].int_value = config_values[other_variable_index].int_value;
+                config_references[index] = other_variable_index;
                 continue;
             }
             config_values[index].int_value = x.unwrap;
@@ -250,8 +350,10 @@ Config_Parse_Result parse_config_text(String_View input)
                 if (other_variable_result.is_error) {
                     return other_variable_result;
                 }
+                config_forward_references[index] = !config_is_backward_reference(index, other_variable_index);
 
                 config_values[index].float_value = config_values[other_variable_index].float_value;
+                config_references[index] = other_variable_index;
                 continue;
             }
             config_values[index].float_value = x.unwrap;
@@ -274,8 +376,10 @@ Config_Parse_Result parse_config_text(String_View input)
                 if (other_variable_result.is_error) {
                     return other_variable_result;
                 }
+                config_forward_references[index] = !config_is_backward_reference(index, other_variable_index);
 
                 config_values[index].string_value = config_values[other_variable_index].string_value;
+                config_references[index] = other_variable_index;
                 continue;
             }
             config_values[index].string_value = x.unwrap;
@@ -306,6 +410,53 @@ Config_Parse_Result reload_config_file(const char *file_path)
     input.data = config_file_buffer;
     fclose(f);
 
-    memset(config_values, 0, sizeof(Config_Value) * CONFIG_VAR_CAPACITY);
-    return parse_config_text(input);
+    const bool full_reload = config_needs_full_reload;
+    config_needs_full_reload = false;
+    if (full_reload) {
+        memset(config_values, 0, sizeof(Config_Value) * CONFIG_VAR_CAPACITY);
+        memset(config_defined, 0, sizeof(config_defined));
+    }
+
+    for (size_t i = 0; i < config_changed_count; ++i) {
+        config_changed[config_changed_indices[i]] = false;
+    }
+    config_changed_count = 0;
+    memset(config_seen, 0, sizeof(config_seen));
+
+    auto result = parse_config_text(input);
+    if (result.is_error) {
+        // NOTE: the file was applied only partially, so the next
+        // reload must not trust any of the remembered lines
+        config_needs_full_reload = true;
+        return result;
+    }
+
+    // NOTE: the variables that were removed from the file go back to
+    // zero, the same way they would be after a full reload
+    for (size_t i = 0; i < CONFIG_VAR_CAPACITY; ++i) {
+        if (config_defined[i] && !config_seen[i]) {
+            config_values[i] = {};
+            config_defined[i] = false;
+            config_mark_changed(i);
+        }
+    }
+
+    // NOTE: the incremental parse met a reference to a variable that is
+    // defined later or was removed, so some of the values it kept may
+    // differ from a full reload. Redo it from scratch. Every variable
+    // of the file gets marked as changed, on top of the removed ones.
+    if (config_needs_full_reload && !full_reload) {
+        memset(config_values, 0, sizeof(Config_Value) * CONFIG_VAR_CAPACITY);
+        memset(config_defined, 0, sizeof(config_defined));
+        memset(config_seen, 0, sizeof(config_seen));
+
+        result = parse_config_text(input);
+        if (result.is_error) {
+            config_needs_full_reload = true;
+            return result;
+        }
+    }
+    config_needs_full_reload = false;
+
+    return result;
 }
@@ -0,0 +1,23 @@
+#ifndef CONFIG_HASH_HPP_
+#define CONFIG_HASH_HPP_
+
+// NOTE: shared by config_typer, which searches for the seeds of the
+// perfect hash of the variable names, and by the generated
+// config_index_by_name, which uses them.
+inline uint32_t config_name_hash(String_View name, uint32_t seed)
+{
+    uint32_t hash = 2166136261u ^ seed;
+    for (size_t i = 0; i < name.count; ++i) {
+        hash ^= (uint8_t) name.data[i];
+        hash *= 16777619u;
+    }
+
+    // NOTE: FNV-1a mixes the high bits better than the low ones and we
+    // are going to mask the low ones
+    hash ^= hash >> 15;
+    hash *= 0x2c1b3c6du;
+    hash ^= hash >> 12;
+    return hash;
+}
+
+#endif  // CONFIG_HASH_HPP_
@@ -13,18 +13,138 @@
 
 using namespace aids;
 
-const size_t CONFIG_VAR_CAPACITY = 1024;
+#include "./config_hash.hpp"
+
+const size_t CONFIG_VAR_CAPACITY = 16 * 1024;
 String_View names[CONFIG_VAR_CAPACITY];
 String_View types[CONFIG_VAR_CAPACITY];
 size_t config_count = 0;
 
+// NOTE: the perfect hash is "hash and displace". The names are split
+// into buckets by config_name_hash(name, 0), then every bucket, the
+// biggest ones first, gets a seed that puts all of its names into
+// free slots of the table with config_name_hash(name, seed).
+const uint32_t CONFIG_HASH_MAX_SEED = 1000000;
+size_t hash_buckets_count = 0;
+size_t hash_slots_count = 0;
+uint32_t hash_seeds[CONFIG_VAR_CAPACITY];
+int hash_slots[4 * CONFIG_VAR_CAPACITY];
+size_t bucket_of[CONFIG_VAR_CAPACITY];
+size_t bucket_sizes[CONFIG_VAR_CAPACITY];
+size_t bucket_order[CONFIG_VAR_CAPACITY];
+
+size_t next_pow2(size_t x)
+{
+    size_t result = 1;
+    while (result < x) result *= 2;
+    return result;
+}
+
+int compare_buckets_by_size_desc(const void *a, const void *b)
+{
+    const size_t x = bucket_sizes[*(const size_t *) a];
+    const size_t y = bucket_sizes[*(const size_t *) b];
+    return (x < y) - (x > y);
+}
+
+void build_perfect_hash()
+{
+    hash_buckets_count = next_pow2(max(config_count / 2, (size_t) 1));
+    hash_slots_count = next_pow2(max(config_count * 2, (size_t) 16));
+
+    for (size_t i = 0; i < hash_buckets_count; ++i) {
+        bucket_sizes[i] = 0;
+        bucket_order[i] = i;
+        hash_seeds[i] = 0;
+    }
+    for (size_t i = 0; i < hash_slots_count; ++i) {
+        hash_slots[i] = -1;
+    }
+
+    for (size_t i = 0; i < config_count; ++i) {
+        bucket_of[i] = config_name_hash(names[i], 0) & (hash_buckets_count - 1);
+        bucket_sizes[bucket_of[i]] += 1;
+    }
+
+    qsort(bucket_order, hash_buckets_count, sizeof(bucket_order[0]), compare_buckets_by_size_desc);
+
+    size_t members[CONFIG_VAR_CAPACITY];
+    size_t slots[CONFIG_VAR_CAPACITY];
+    for (size_t k = 0; k < hash_buckets_count; ++k) {
+        const size_t bucket = bucket_order[k];
+        if (bucket_sizes[bucket] == 0) break;
+
+        size_t members_count = 0;
+        for (size_t i = 0; i < config_count; ++i) {
+            if (bucket_of[i] == bucket) members[members_count++] = i;
+        }
+
+        bool found = false;
+        for (uint32_t seed = 1; !found && seed < CONFIG_HASH_MAX_SEED; ++seed) {
+            found = true;
+            for (size_t j = 0; found && j < members_count; ++j) {
+                slots[j] = config_name_hash(names[members[j]], seed) & (hash_slots_count - 1);
+                if (hash_slots[slots[j]] >= 0) found = false;
+                for (size_t l = 0; found && l < j; ++l) {
+                    if (slots[l] == slots[j]) found = false;
+                }
+            }
+
+            if (found) {
+                hash_seeds[bucket] = seed;
+                for (size_t j = 0; j < members_count; ++j) {
+                    hash_slots[slots[j]] = (int) members[j];
+                }
+            }
+        }
+
+        if (!found) {
+            println(stderr, "Could not find a perfect hash for the variable names");
+            exit(1);
+        }
+    }
+}
+
+// NOTE: prints a config with `count` variables of all of the types,
+// some of them referring to the previous ones, for the config_bench
+void print_synthetic_config(size_t count)
+{
+    println(stdout, "# Generated by `", __FILE__, "` for the config_bench");
+    for (size_t i = 0; i < count; ++i) {
+        char name[64];
+        snprintf(name, sizeof(name), "SYNTHETIC_VAR_%05zu", i);
+        switch (i % 5) {
+        case 0: println(stdout, name, " : int    = ", i); break;
+        case 1: println(stdout, name, " : float  = ", i, ".5"); break;
+        case 2: println(stdout, name, " : color  = 1f2f3fff # a comment"); break;
+        case 3: println(stdout, name, " : string = \"value ", i, "\""); break;
+        case 4: {
+            char other[64];
+            snprintf(other, sizeof(other), "SYNTHETIC_VAR_%05zu", i - 4);
+            println(stdout, name, " : int    = ", other);
+        } break;
+        }
+    }
+}
+
 int main(int argc, char *argv[])
 {
     if (argc < 2) {
         println(stderr, "Usage: ./config_typer <config.var>");
+        println(stderr, "       ./config_typer --synthetic <count>");
         exit(1);
     }
 
+    if (strcmp(argv[1], "--synthetic") == 0) {
+        const size_t count = argc >= 3 ? (size_t) strtoul(argv[2], NULL, 10) : 4096;
+        if (count == 0 || count > CONFIG_VAR_CAPACITY) {
+            println(stderr, "The count must be between 1 and ", CONFIG_VAR_CAPACITY);
+            exit(1);
+        }
+        print_synthetic_config(count);
+        return 0;
+    }
+
     auto input = read_file_as_string_view(argv[1]);
     if (!input.has_value) {
         println(stderr, "Could not read file `", argv[1], "`");
@@ -37,11 +157,26 @@ int main(int argc, char *argv[])
         if (line.count == 0)   continue; // skip empty lines
         if (*line.data == '#') continue; // skip commentsa
 
+        if (config_count >= CONFIG_VAR_CAPACITY) {
+            println(stderr, "Too many variables. The limit is ", CONFIG_VAR_CAPACITY);
+            exit(1);
+        }
+
         names[config_count] = line.chop_by_delim(':').trim();
         types[config_count] = line.chop_by_delim('=').trim();
+
+        for (size_t i = 0; i < config_count; ++i) {
+            if (names[i] == names[config_count]) {
+                println(stderr, "Variable `", names[i], "` is defined more than once");
+                exit(1);
+            }
+        }
+
         config_count += 1;
     }
 
+    build_perfect_hash();
+
     println(stdout, "// Generated by `", __FILE__, "` from `", argv[1], "`");
     println(stdout, "#define CONFIG_VAR_CAPACITY ", config_count);
     for (size_t i = 0; i < config_count; ++i) {
@@ -50,23 +185,46 @@ int main(int argc, char *argv[])
 
     println(stdout);
 
-    println(stdout,     "ssize_t config_index_by_name(String_View name) {");
+    println(stdout,     "String_View config_names[CONFIG_VAR_CAPACITY] {");
     for (size_t i = 0; i < config_count; ++i) {
-        println(stdout, "    if (name == \"", names[i], "\"_sv) return ", i, ";");
+        println(stdout, "    \"", names[i], "\"_sv,");
     }
-    println(stdout,     "    return -1;");
-    println(stdout,     "}");
+    println(stdout,     "};");
 
     println(stdout);
 
-    println(stdout,     "String_View config_names[CONFIG_VAR_CAPACITY] {");
-    for (size_t i = 0; i < config_count; ++i) {
-        println(stdout, "    \"", names[i], "\"_sv,");
+    println(stdout,     "#define CONFIG_HASH_BUCKETS ", hash_buckets_count);
+    println(stdout,     "#define CONFIG_HASH_SLOTS ", hash_slots_count);
+    println(stdout,     "const uint32_t config_hash_seeds[CONFIG_HASH_BUCKETS] {");
+    for (size_t i = 0; i < hash_buckets_count; i += 16) {
+        print(stdout,   "   ");
+        for (size_t j = i; j < min(i + 16, hash_buckets_count); ++j) {
+            print(stdout, " ", hash_seeds[j], ",");
+        }
+        println(stdout);
+    }
+    println(stdout,     "};");
+    println(stdout,     "const int config_hash_slots[CONFIG_HASH_SLOTS] {");
+    for (size_t i = 0; i < hash_slots_count; i += 16) {
+        print(stdout,   "   ");
+        for (size_t j = i; j < min(i + 16, hash_slots_count); ++j) {
+            print(stdout, " ", hash_slots[j], ",");
+        }
+        println(stdout);
     }
     println(stdout,     "};");
 
     println(stdout);
 
+    println(stdout,     "ssize_t config_index_by_name(String_View name) {");
+    println(stdout,     "    const uint32_t seed = config_hash_seeds[config_name_hash(name, 0) & (CONFIG_HASH_BUCKETS - 1)];");
+    println(stdout,     "    const int index = config_hash_slots[config_name_hash(name, seed) & (CONFIG_HASH_SLOTS - 1)];");
+    println(stdout,     "    if (index >= 0 && config_names[index] == name) return index;");
+    println(stdout,     "    return -1;");
+    println(stdout,     "}");
+
+    println(stdout);
+
     println(stdout,     "Config_Type config_types[CONFIG_VAR_CAPACITY] {");
     for (size_t i = 0; i < config_count; ++i) {
         println(stdout, "    CONFIG_TYPE_", Caps { types[i] }, ",");
@@ -3,6 +3,7 @@
 #include <cstdlib>
 #include <cerrno>
 #include <cmath>
+#include <ctime>
 #include <SDL.h>
 
 #ifdef SOMETHING_RELEASE
@@ -47,6 +48,7 @@ typedef SSIZE_T ssize_t;
 #include <dirent.h>
 #endif // _WIN32
 #include "something_error.cpp"
+#include "something_profiler.cpp"
 #include "something_color.cpp"
 #include "something_render.cpp"
 #include "something_font.cpp"
@@ -54,7 +56,9 @@ typedef SSIZE_T ssize_t;
 #include "something_texture.cpp"
 #include "something_sprite.cpp"
 #include "something_tile_grid.cpp"
+#include "something_world.cpp"
 #include "something_sound.cpp"
+#include "something_audio_render.cpp"
 #include "something_entity.cpp"
 #include "something_popup.cpp"
 #include "something_item.cpp"
@@ -66,5 +70,10 @@ typedef SSIZE_T ssize_t;
 #include "something_particles.cpp"
 #include "something_background.cpp"
 #include "something_game.cpp"
+#include "something_world_streamer.cpp"
+#include "something_snapshot.cpp"
+#include "something_replay.cpp"
+#include "something_state_hash.cpp"
 #include "something_main.cpp"
+#include "something_memory.cpp"
 #include "something_assets.cpp"
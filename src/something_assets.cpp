@@ -2,6 +2,64 @@
 
 Assets assets = {};
 
+// FNV-1a
+uint32_t hash_asset_id(String_View id)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < id.count; ++i) {
+        hash ^= (uint8_t) id.data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void Asset_Id_Table::clear()
+{
+    memset(slots, 0, sizeof(slots));
+}
+
+void Asset_Id_Table::insert(String_View id, size_t index)
+{
+    static_assert((ASSETS_ID_TABLE_CAPACITY & (ASSETS_ID_TABLE_CAPACITY - 1)) == 0);
+
+    const uint32_t hash = hash_asset_id(id);
+    for (size_t i = 0; i < ASSETS_ID_TABLE_CAPACITY; ++i) {
+        Slot *slot = &slots[(hash + i) & (ASSETS_ID_TABLE_CAPACITY - 1)];
+        if (!slot->occupied) {
+            slot->occupied = true;
+            slot->hash = hash;
+            slot->id = id;
+            slot->index = index;
+            return;
+        }
+
+        // NOTE: the first definition of the id wins, the same way the
+        // old linear lookup used to behave.
+        if (slot->hash == hash && slot->id == id) {
+            return;
+        }
+    }
+
+    assert(0 && "Asset_Id_Table overflow");
+}
+
+Maybe<size_t> Asset_Id_Table::find(String_View id) const
+{
+    const uint32_t hash = hash_asset_id(id);
+    for (size_t i = 0; i < ASSETS_ID_TABLE_CAPACITY; ++i) {
+        const Slot *slot = &slots[(hash + i) & (ASSETS_ID_TABLE_CAPACITY - 1)];
+        if (!slot->occupied) {
+            break;
+        }
+
+        if (slot->hash == hash && slot->id == id) {
+            return {true, slot->index};
+        }
+    }
+
+    return {};
+}
+
 String_View Assets::load_file_into_conf_buffer(const char *filepath)
 {
     FILE *conf_file = fopen(filepath, "rb");
@@ -43,12 +101,8 @@ String_View Assets::load_file_into_conf_buffer(const char *filepath)
     return {(size_t) m, conf_buffer};
 }
 
-void Assets::load_texture(SDL_Renderer *renderer, String_View id, String_View path)
+Texture load_texture_file(SDL_Renderer *renderer, String_View path)
 {
-    assert(textures_count < ASSETS_TEXTURES_CAPACITY);
-
-    println(stdout, "Loading texture ", id, " from ", path, "...");
-
     Texture asset = {};
     asset.surface = load_png_file_as_surface(path);
     asset.texture = sec(SDL_CreateTextureFromSurface(renderer, asset.surface));
@@ -66,15 +120,36 @@ void Assets::load_texture(SDL_Renderer *renderer, String_View id, String_View pa
 
     asset.texture_mask = sec(SDL_CreateTextureFromSurface(renderer, asset.surface_mask));
 
+    return asset;
+}
+
+void destroy_texture(Texture texture)
+{
+    SDL_FreeSurface(texture.surface);
+    SDL_DestroyTexture(texture.texture);
+    SDL_FreeSurface(texture.surface_mask);
+    SDL_DestroyTexture(texture.texture_mask);
+}
+
+void Assets::load_texture(SDL_Renderer *renderer, String_View id, String_View path)
+{
+    assert(textures_count < ASSETS_TEXTURES_CAPACITY);
+
+    println(stdout, "Loading texture ", id, " from ", path, "...");
+
+    texture_ids.insert(id, textures_count);
     textures[textures_count].id = id;
     textures[textures_count].path = path;
-    textures[textures_count].unwrap = asset;
+    textures[textures_count].unwrap = load_texture_file(renderer, path);
     textures_count += 1;
 }
 
 void Assets::load_sound(String_View id, String_View path)
 {
+    assert(sounds_count < ASSETS_SOUNDS_CAPACITY);
+
     println(stdout, "Loading sound ", id, " from ", path, "...");
+    sound_ids.insert(id, sounds_count);
     sounds[sounds_count].id = id;
     sounds[sounds_count].path = path;
     sounds[sounds_count].unwrap = load_wav_as_sample_s16(path);
@@ -90,10 +165,8 @@ Maybe<String_View> read_file_as_string_view(String_View filename)
     return read_file_as_string_view(filename_cstr);
 }
 
-void Assets::load_animat(String_View id, String_View path)
+Frame_Animat Assets::load_animat_file(String_View path)
 {
-    println(stdout, "Loading animat ", id, " from ", path, "...");
-
     auto source = read_file_as_string_view(path);
     if (!source.has_value) {
         println(stderr, "Could not load animation file: `", path, "`");
@@ -196,18 +269,84 @@ void Assets::load_animat(String_View id, String_View path)
         }
     }
 
+    return animat;
+}
+
+void Assets::load_animat(String_View id, String_View path)
+{
+    println(stdout, "Loading animat ", id, " from ", path, "...");
+
+    assert(animats_count < ASSETS_ANIMATS_CAPACITY);
+    animat_ids.insert(id, animats_count);
     animats[animats_count].id = id;
     animats[animats_count].path = path;
-    animats[animats_count].unwrap = animat;
+    animats[animats_count].unwrap = load_animat_file(path);
     animats_count += 1;
 }
 
-Maybe<Sample_S16_Index> Assets::get_sound_by_id(String_View id)
+// NOTE: the hot reload of a single asset. The indices stay the same,
+// so everything that refers to the asset picks up the new version.
+void Assets::reload_texture(SDL_Renderer *renderer, Texture_Index index)
+{
+    PROFILE_ZONE("Assets::reload_texture");
+    assert(index.unwrap < textures_count);
+    auto texture = &textures[index.unwrap];
+    println(stdout, "Reloading texture ", texture->id, " from ", texture->path, "...");
+    destroy_texture(texture->unwrap);
+    texture->unwrap = load_texture_file(renderer, texture->path);
+}
+
+// NOTE: the mixer must not be playing the sample while it is reloaded
+// (see Sample_Mixer::stop_all() and Sample_Mixer::sync())
+void Assets::reload_sound(Sample_S16_Index index)
+{
+    PROFILE_ZONE("Assets::reload_sound");
+    assert(index.unwrap < sounds_count);
+    auto sound = &sounds[index.unwrap];
+    println(stdout, "Reloading sound ", sound->id, " from ", sound->path, "...");
+    SDL_FreeWAV((Uint8*) sound->unwrap.audio_buf);
+    sound->unwrap = load_wav_as_sample_s16(sound->path);
+}
+
+void Assets::reload_animat(Frame_Animat_Index index)
+{
+    PROFILE_ZONE("Assets::reload_animat");
+    assert(index.unwrap < animats_count);
+    auto animat = &animats[index.unwrap];
+    println(stdout, "Reloading animat ", animat->id, " from ", animat->path, "...");
+    delete[] animat->unwrap.frames;
+    animat->unwrap = load_animat_file(animat->path);
+}
+
+Maybe<Texture_Index> Assets::get_texture_by_path(String_View path)
+{
+    for (size_t i = 0; i < textures_count; ++i) {
+        if (textures[i].path == path) return {true, {i}};
+    }
+    return {};
+}
+
+Maybe<Sample_S16_Index> Assets::get_sound_by_path(String_View path)
 {
     for (size_t i = 0; i < sounds_count; ++i) {
-        if (sounds[i].id == id) {
-            return {true, {i}};
-        }
+        if (sounds[i].path == path) return {true, {i}};
+    }
+    return {};
+}
+
+Maybe<Frame_Animat_Index> Assets::get_animat_by_path(String_View path)
+{
+    for (size_t i = 0; i < animats_count; ++i) {
+        if (animats[i].path == path) return {true, {i}};
+    }
+    return {};
+}
+
+Maybe<Sample_S16_Index> Assets::get_sound_by_id(String_View id)
+{
+    auto index = sound_ids.find(id);
+    if (index.has_value) {
+        return {true, {index.unwrap}};
     }
     return {};
 }
@@ -221,10 +360,9 @@ Sample_S16_Index Assets::get_sound_by_id_or_panic(String_View id)
 
 Maybe<Texture_Index> Assets::get_texture_by_id(String_View id)
 {
-    for (size_t i = 0; i < textures_count; ++i) {
-        if (textures[i].id == id) {
-            return {true, {i}};
-        }
+    auto index = texture_ids.find(id);
+    if (index.has_value) {
+        return {true, {index.unwrap}};
     }
 
     return {};
@@ -239,10 +377,9 @@ Texture_Index Assets::get_texture_by_id_or_panic(String_View id)
 
 Maybe<Frame_Animat_Index> Assets::get_animat_by_id(String_View id)
 {
-    for (size_t i = 0; i < animats_count; ++i) {
-        if (animats[i].id == id) {
-            return {true, {i}};
-        }
+    auto index = animat_ids.find(id);
+    if (index.has_value) {
+        return {true, {index.unwrap}};
     }
 
     return {};
@@ -255,13 +392,31 @@ Frame_Animat_Index Assets::get_animat_by_id_or_panic(String_View id)
         "Could not find animat with id `", id, "`");
 }
 
+void Assets::resolve_handles()
+{
+    handles.health_item_texture      = get_texture_by_id_or_panic("HEALTH_ITEM_TEXTURE"_sv);
+
+    handles.jump1_sound              = get_sound_by_id_or_panic("JUMP1_SOUND"_sv);
+    handles.jump2_sound              = get_sound_by_id_or_panic("JUMP2_SOUND"_sv);
+    handles.pew_sound                = get_sound_by_id_or_panic("PEW_SOUND"_sv);
+    handles.pop_sound                = get_sound_by_id_or_panic("POP_SOUND"_sv);
+    handles.oof_sound                = get_sound_by_id_or_panic("OOF_SOUND"_sv);
+    handles.crunch_sound             = get_sound_by_id_or_panic("CRUNCH_SOUND"_sv);
+
+    handles.player_animat            = get_animat_by_id_or_panic("PLAYER_ANIMAT"_sv);
+    handles.enemy_idle_animat        = get_animat_by_id_or_panic("ENEMY_IDLE_ANIMAT"_sv);
+    handles.enemy_walking_animat     = get_animat_by_id_or_panic("ENEMY_WALKING_ANIMAT"_sv);
+    handles.dirt_golem_animat        = get_animat_by_id_or_panic("DIRT_GOLEM_ANIMAT"_sv);
+    handles.ice_golem_idle_animat    = get_animat_by_id_or_panic("ICE_GOLEM_IDLE_ANIMAT"_sv);
+    handles.ice_golem_walking_animat = get_animat_by_id_or_panic("ICE_GOLEM_WALKING_ANIMAT"_sv);
+    handles.projectile_idle_animat   = get_animat_by_id_or_panic("PROJECTILE_IDLE_ANIMAT"_sv);
+    handles.projectile_poof_animat   = get_animat_by_id_or_panic("PROJECTILE_POOF_ANIMAT"_sv);
+}
+
 void Assets::clean()
 {
     for (size_t i = 0; i < textures_count; ++i) {
-        SDL_FreeSurface(textures[i].unwrap.surface);
-        SDL_DestroyTexture(textures[i].unwrap.texture);
-        SDL_FreeSurface(textures[i].unwrap.surface_mask);
-        SDL_DestroyTexture(textures[i].unwrap.texture_mask);
+        destroy_texture(textures[i].unwrap);
     }
     textures_count = 0;
 
@@ -274,10 +429,15 @@ void Assets::clean()
         delete[] animats[i].unwrap.frames;
     }
     animats_count = 0;
+
+    texture_ids.clear();
+    sound_ids.clear();
+    animat_ids.clear();
 }
 
 void Assets::load_conf(SDL_Renderer *renderer, const char *filepath)
 {
+    PROFILE_ZONE("Assets::load_conf");
     clean();
 
     String_View input = load_file_into_conf_buffer(filepath);
@@ -307,5 +467,7 @@ void Assets::load_conf(SDL_Renderer *renderer, const char *filepath)
         }
     }
 
+    resolve_handles();
+
     loaded_first_time = true;
 }
@@ -7,6 +7,9 @@ const size_t ASSETS_CONF_BUFFER_CAPACITY = 1024 * 1024;
 const size_t ASSETS_TEXTURES_CAPACITY = 128;
 const size_t ASSETS_SOUNDS_CAPACITY = 128;
 const size_t ASSETS_ANIMATS_CAPACITY = 128;
+// NOTE: must be a power of two and at least twice as big as any of
+// the capacities above so the open addressing never gets crowded
+const size_t ASSETS_ID_TABLE_CAPACITY = 256;
 
 template <typename T>
 struct Asset
@@ -16,6 +19,50 @@ struct Asset
     T unwrap;
 };
 
+// NOTE: maps asset ids to their indices in the corresponding asset
+// array. Built in Assets::load_conf so lookups by id are a hash
+// instead of a linear scan with string comparisons.
+struct Asset_Id_Table
+{
+    struct Slot
+    {
+        bool occupied;
+        uint32_t hash;
+        String_View id;
+        size_t index;
+    };
+
+    Slot slots[ASSETS_ID_TABLE_CAPACITY];
+
+    void clear();
+    void insert(String_View id, size_t index);
+    Maybe<size_t> find(String_View id) const;
+};
+
+// NOTE: well-known assets the game refers to every frame. Resolved
+// once at the end of Assets::load_conf (on startup and on F6), so the
+// per-frame code never looks anything up by id.
+struct Asset_Handles
+{
+    Texture_Index health_item_texture;
+
+    Sample_S16_Index jump1_sound;
+    Sample_S16_Index jump2_sound;
+    Sample_S16_Index pew_sound;
+    Sample_S16_Index pop_sound;
+    Sample_S16_Index oof_sound;
+    Sample_S16_Index crunch_sound;
+
+    Frame_Animat_Index player_animat;
+    Frame_Animat_Index enemy_idle_animat;
+    Frame_Animat_Index enemy_walking_animat;
+    Frame_Animat_Index dirt_golem_animat;
+    Frame_Animat_Index ice_golem_idle_animat;
+    Frame_Animat_Index ice_golem_walking_animat;
+    Frame_Animat_Index projectile_idle_animat;
+    Frame_Animat_Index projectile_poof_animat;
+};
+
 struct Texture
 {
     SDL_Surface *surface;
@@ -24,6 +71,9 @@ struct Texture
     SDL_Texture *texture_mask;
 };
 
+Texture load_texture_file(SDL_Renderer *renderer, String_View path);
+void destroy_texture(Texture texture);
+
 struct Assets
 {
     bool loaded_first_time;
@@ -36,6 +86,12 @@ struct Assets
     size_t animats_count;
     Asset<Frame_Animat> animats[ASSETS_ANIMATS_CAPACITY];
 
+    Asset_Id_Table texture_ids;
+    Asset_Id_Table sound_ids;
+    Asset_Id_Table animat_ids;
+
+    Asset_Handles handles;
+
     Maybe<Texture_Index> get_texture_by_id(String_View id);
     Texture_Index get_texture_by_id_or_panic(String_View id);
 
@@ -45,11 +101,22 @@ struct Assets
     Maybe<Frame_Animat_Index> get_animat_by_id(String_View id);
     Frame_Animat_Index get_animat_by_id_or_panic(String_View id);
 
+    Maybe<Texture_Index> get_texture_by_path(String_View path);
+    Maybe<Sample_S16_Index> get_sound_by_path(String_View path);
+    Maybe<Frame_Animat_Index> get_animat_by_path(String_View path);
+
     String_View load_file_into_conf_buffer(const char *filepath);
     void load_texture(SDL_Renderer *renderer, String_View id, String_View path);
     void load_sound(String_View id, String_View path);
+    Frame_Animat load_animat_file(String_View path);
     void load_animat(String_View id, String_View path);
 
+    void reload_texture(SDL_Renderer *renderer, Texture_Index index);
+    void reload_sound(Sample_S16_Index index);
+    void reload_animat(Frame_Animat_Index index);
+
+    void resolve_handles();
+
     void clean();
     void load_conf(SDL_Renderer *renderer, const char *filepath);
 };
@@ -0,0 +1,223 @@
+#include "./something_audio_render.hpp"
+
+struct Audio_Render_Samples
+{
+    String_View paths[AUDIO_RENDER_SAMPLES_CAPACITY];
+    Sample_S16 samples[AUDIO_RENDER_SAMPLES_CAPACITY];
+    size_t count;
+
+    size_t load(String_View path)
+    {
+        for (size_t i = 0; i < count; ++i) {
+            if (paths[i] == path) return i;
+        }
+
+        if (count >= AUDIO_RENDER_SAMPLES_CAPACITY) {
+            println(stderr, "[ERROR] Too many different samples in the script. The limit is ",
+                    AUDIO_RENDER_SAMPLES_CAPACITY);
+            exit(1);
+        }
+
+        paths[count] = path;
+        samples[count] = load_wav_as_sample_s16(path);
+        return count++;
+    }
+
+    void clean()
+    {
+        for (size_t i = 0; i < count; ++i) {
+            SDL_FreeWAV((Uint8*) samples[i].audio_buf);
+        }
+        count = 0;
+    }
+};
+
+static void put_u16_le(Uint8 *bytes, Uint32 x)
+{
+    bytes[0] = (Uint8) x;
+    bytes[1] = (Uint8) (x >> 8);
+}
+
+static void put_u32_le(Uint8 *bytes, Uint32 x)
+{
+    put_u16_le(bytes, x & 0xFFFF);
+    put_u16_le(bytes + 2, x >> 16);
+}
+
+static void write_wav_header(FILE *f, Uint32 data_size)
+{
+    const Uint32 channels = SOMETHING_SOUND_CHANNELS;
+    const Uint32 freq = SOMETHING_SOUND_FREQ;
+    const Uint32 block_align = channels * sizeof(int16_t);
+    const Uint32 byte_rate = freq * block_align;
+
+    Uint8 header[44] = {};
+
+    memcpy(header, "RIFF", 4);
+    put_u32_le(header + 4, 36 + data_size);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    put_u32_le(header + 16, 16);
+    put_u16_le(header + 20, 1);
+    put_u16_le(header + 22, channels);
+    put_u32_le(header + 24, freq);
+    put_u32_le(header + 28, byte_rate);
+    put_u16_le(header + 32, block_align);
+    put_u16_le(header + 34, 16);
+    memcpy(header + 36, "data", 4);
+    put_u32_le(header + 40, data_size);
+
+    fwrite(header, sizeof(header), 1, f);
+}
+
+int render_audio_offline(const char *script_path, const char *output_path)
+{
+#ifndef SOMETHING_RELEASE
+    {
+        auto result = reload_config_file(VARS_CONF_FILE_PATH);
+        if (result.is_error) {
+            println(stderr, VARS_CONF_FILE_PATH, ":", result.line, ": ", result.message);
+            return 1;
+        }
+    }
+#endif // SOMETHING_RELEASE
+
+    auto script = read_file_as_string_view(script_path);
+    if (!script.has_value) {
+        println(stderr, "Could not read file `", script_path, "`");
+        return 1;
+    }
+
+    static Audio_Render_Samples samples = {};
+    defer(samples.clean());
+
+    Dynamic_Array<Audio_Render_Event> events = {};
+    defer(free(events.data));
+
+    String_View input = script.unwrap;
+    for (size_t line_number = 1; input.count > 0; ++line_number) {
+        String_View line = input.chop_by_delim('\n').trim();
+        if (line.count == 0 || *line.data == '#') continue;
+
+        Audio_Render_Event event = {};
+        event.gain = 1.0f;
+
+        auto time = line.chop_word().as_float();
+        line = line.trim();
+        String_View path = line.chop_word();
+        if (!time.has_value || path.count == 0) {
+            println(stderr, script_path, ":", line_number, ": expected <time> <wav file>");
+            return 1;
+        }
+        event.time = time.unwrap;
+        event.sample = samples.load(path);
+
+        line = line.trim();
+        if (line.count > 0) {
+            auto gain = line.chop_word().as_float();
+            if (!gain.has_value) {
+                println(stderr, script_path, ":", line_number, ": gain is not a float");
+                return 1;
+            }
+            event.gain = gain.unwrap;
+        }
+
+        line = line.trim();
+        if (line.count > 0) {
+            auto x = line.chop_word().as_float();
+            line = line.trim();
+            auto y = line.chop_word().as_float();
+            if (!x.has_value || !y.has_value) {
+                println(stderr, script_path, ":", line_number, ": position is not a pair of floats");
+                return 1;
+            }
+            event.positional = true;
+            event.pos = vec2(x.unwrap, y.unwrap);
+        }
+
+        if (events.size > 0 && event.time < events.data[events.size - 1].time) {
+            println(stderr, script_path, ":", line_number, ": events must be sorted by time");
+            return 1;
+        }
+
+        events.push(event);
+    }
+
+    FILE *output = fopen(output_path, "wb");
+    if (output == NULL) {
+        println(stderr, "Could not open file `", output_path, "`: ", strerror(errno));
+        return 1;
+    }
+    defer(fclose(output));
+    write_wav_header(output, 0);
+
+    // NOTE: the mixer is driven from this thread only. There is no
+    // audio thread that would drain the queue, so the commands are
+    // processed right where they are pushed.
+    static Sample_Mixer mixer = {};
+    mixer.no_device = true;
+    mixer.listener = vec2(0.0f, 0.0f);
+    mixer.set_volume(1.0f);
+
+    const Sound_Params default_params = {0, 0, 1.0f};
+    static int16_t block[AUDIO_RENDER_BLOCK_FRAMES * SOMETHING_SOUND_CHANNELS];
+    const size_t tail_limit = (size_t) (AUDIO_RENDER_TAIL_LIMIT_SECS * SOMETHING_SOUND_FREQ);
+
+    size_t frames = 0;
+    size_t next_event = 0;
+    size_t tail = 0;
+    Uint64 mixing_ticks = 0;
+    for (;;) {
+        const float block_end = (float) (frames + AUDIO_RENDER_BLOCK_FRAMES) / SOMETHING_SOUND_FREQ;
+        while (next_event < events.size && events.data[next_event].time < block_end) {
+            const Audio_Render_Event &event = events.data[next_event];
+            Sound_Params params = default_params;
+            params.gain = event.gain;
+            if (event.positional) {
+                mixer.play_sample_at(samples.samples[event.sample], params, event.pos);
+            } else {
+                mixer.play_sample(samples.samples[event.sample], params);
+            }
+            // NOTE: a block may hold more events than the queue. They
+            // would be dropped before the callback gets to them.
+            mixer.process_commands();
+            next_event += 1;
+        }
+
+        const Uint64 begin = SDL_GetPerformanceCounter();
+        sample_mixer_audio_callback(&mixer, (Uint8*) block, (int) sizeof(block));
+        mixing_ticks += SDL_GetPerformanceCounter() - begin;
+
+        fwrite(block, sizeof(block), 1, output);
+        frames += AUDIO_RENDER_BLOCK_FRAMES;
+
+        if (next_event >= events.size) {
+            tail += AUDIO_RENDER_BLOCK_FRAMES;
+            if (mixer.count_active_voices() == 0 || tail >= tail_limit) break;
+        }
+    }
+
+    const Uint32 data_size = (Uint32) (frames * SOMETHING_SOUND_CHANNELS * sizeof(int16_t));
+    fseek(output, 0, SEEK_SET);
+    write_wav_header(output, data_size);
+
+    const double seconds = (double) mixing_ticks / (double) SDL_GetPerformanceFrequency();
+    const double audio_seconds = (double) frames / SOMETHING_SOUND_FREQ;
+    println(stdout, "Rendered ", events.size, " events into ", output_path, ": ",
+            frames, " frames (", (float) audio_seconds, " s) in ", (float) (seconds * 1000.0), " ms");
+    println(stdout, "Mixed samples/sec: ",
+            (float) ((double) (frames * SOMETHING_SOUND_CHANNELS) / seconds),
+            " (", (float) (audio_seconds / seconds), "x realtime)");
+    println(stdout, "Dropped: ", SDL_AtomicGet(&mixer.stats.dropped),
+            ", culled: ", SDL_AtomicGet(&mixer.stats.culled));
+
+    // NOTE: the events have the same priority, so there is always a
+    // voice to steal. A dropped sound means the render does not match
+    // the script.
+    if (SDL_AtomicGet(&mixer.stats.dropped) != 0) {
+        println(stderr, "[ERROR] ", SDL_AtomicGet(&mixer.stats.dropped),
+                " sounds were dropped, ", output_path, " does not match ", script_path);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,30 @@
+#ifndef SOMETHING_AUDIO_RENDER_HPP_
+#define SOMETHING_AUDIO_RENDER_HPP_
+
+// NOTE: in frames. Play events land on the boundaries of these blocks,
+// so this is the timing resolution of the render.
+const size_t AUDIO_RENDER_BLOCK_FRAMES = 512;
+const size_t AUDIO_RENDER_SAMPLES_CAPACITY = 64;
+// NOTE: how long the voices may keep ringing after the last event
+const float AUDIO_RENDER_TAIL_LIMIT_SECS = 30.0f;
+
+struct Audio_Render_Event
+{
+    float time;
+    size_t sample;
+    float gain;
+    bool positional;
+    Vec2f pos;
+};
+
+// NOTE: renders a script of play events through
+// sample_mixer_audio_callback without opening an audio device and
+// writes the result into a WAV file. The script is a list of lines
+//
+//     <time in seconds> <wav file> [<gain> [<x> <y>]]
+//
+// sorted by time. Lines starting with # are comments. The events with
+// a position are played relative to a listener at (0, 0).
+int render_audio_offline(const char *script_path, const char *output_path);
+
+#endif  // SOMETHING_AUDIO_RENDER_HPP_
@@ -2,6 +2,8 @@
 
 void Background::render(SDL_Renderer *renderer, Camera camera)
 {
+    Render_Subsystem_Scope scope(RENDER_SUBSYSTEM_BACKGROUND);
+
     for (size_t i = 0; i < BACKGROUND_LAYERS_COUNT; ++i) {
         const float w = (float) layers[i].srcrect.w * BACKGROUND_SCALE_FACTOR;
         const float h = (float) layers[i].srcrect.h * BACKGROUND_SCALE_FACTOR;
@@ -65,12 +65,96 @@ RGBA sdl_to_rgba(SDL_Color sdl_color)
     return rgba;
 }
 
+// NOTE: [0.0, 1.0] -> [0, 255] with rounding to the nearest. Adding
+// 0.5 and truncating is the same as roundf() for non-negative values,
+// but it is a couple of instructions instead of a libm call and
+// vectorizes nicely.
+inline Uint8 color_channel_to_byte(float x)
+{
+    return (Uint8) (clamp(x, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
 SDL_Color rgba_to_sdl(RGBA rgba)
 {
     SDL_Color sdl_color = {};
-    sdl_color.r = (Uint8) roundf(rgba.r * 255.0f);
-    sdl_color.g = (Uint8) roundf(rgba.g * 255.0f);
-    sdl_color.b = (Uint8) roundf(rgba.b * 255.0f);
-    sdl_color.a = (Uint8) roundf(rgba.a * 255.0f);
+    sdl_color.r = color_channel_to_byte(rgba.r);
+    sdl_color.g = color_channel_to_byte(rgba.g);
+    sdl_color.b = color_channel_to_byte(rgba.b);
+    sdl_color.a = color_channel_to_byte(rgba.a);
     return sdl_color;
 }
+
+// NOTE: floorf() that does not turn into a libm call and does not
+// prevent the loops below from being vectorized. Only valid within
+// the range of int, which is more than enough for the hue.
+inline float color_floor(float x)
+{
+    const float t = (float) (int) x;
+    return t - (t > x ? 1.0f : 0.0f);
+}
+
+// NOTE: f(n) = l - a * max(-1, min(k - 3, 9 - k, 1)), where
+//   k = (n + h / 30) mod 12, a = s * min(l, 1 - l)
+// is the branchless form of the six sector HSL -> RGB conversion
+// (r, g, b are f(0), f(8), f(4) respectively).
+inline float hsla_channel(float n, float h30, float l, float a)
+{
+    float k = n + h30;
+    k -= 12.0f * color_floor(k * (1.0f / 12.0f));
+    return l - a * max(-1.0f, min(k - 3.0f, 9.0f - k, 1.0f));
+}
+
+void hsla_to_rgba_batch(const HSLA *hslas, RGBA *rgbas, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        const float h30 = hslas[i].h * (1.0f / 30.0f);
+        const float l = hslas[i].l;
+        const float a = hslas[i].s * min(l, 1.0f - l);
+
+        rgbas[i].r = hsla_channel(0.0f, h30, l, a);
+        rgbas[i].g = hsla_channel(8.0f, h30, l, a);
+        rgbas[i].b = hsla_channel(4.0f, h30, l, a);
+        rgbas[i].a = hslas[i].a;
+    }
+}
+
+RGBA mix_colors(RGBA b32, RGBA a32)
+{
+    const float r_alpha = a32.a + b32.a * (1.0f - a32.a);
+    // NOTE: both colors are fully transparent, so is the result
+    const float inv_r_alpha = r_alpha > 0.0f ? 1.0f / r_alpha : 0.0f;
+
+    RGBA r = {};
+
+    r.r = (a32.r * a32.a + b32.r * b32.a * (1.0f - a32.a)) * inv_r_alpha;
+    r.g = (a32.g * a32.a + b32.g * b32.a * (1.0f - a32.a)) * inv_r_alpha;
+    r.b = (a32.b * a32.a + b32.b * b32.a * (1.0f - a32.a)) * inv_r_alpha;
+    r.a = r_alpha;
+
+    return r;
+}
+
+void mix_colors_batch(const RGBA *bs, const RGBA *as, RGBA *mixed, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        const float a_alpha = as[i].a;
+        const float b_alpha = bs[i].a * (1.0f - a_alpha);
+        const float r_alpha = a_alpha + b_alpha;
+        const float inv_r_alpha = r_alpha > 0.0f ? 1.0f / r_alpha : 0.0f;
+
+        mixed[i].r = (as[i].r * a_alpha + bs[i].r * b_alpha) * inv_r_alpha;
+        mixed[i].g = (as[i].g * a_alpha + bs[i].g * b_alpha) * inv_r_alpha;
+        mixed[i].b = (as[i].b * a_alpha + bs[i].b * b_alpha) * inv_r_alpha;
+        mixed[i].a = r_alpha;
+    }
+}
+
+void rgba_to_sdl_batch(const RGBA *rgbas, SDL_Color *sdl_colors, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        sdl_colors[i].r = color_channel_to_byte(rgbas[i].r);
+        sdl_colors[i].g = color_channel_to_byte(rgbas[i].g);
+        sdl_colors[i].b = color_channel_to_byte(rgbas[i].b);
+        sdl_colors[i].a = color_channel_to_byte(rgbas[i].a);
+    }
+}
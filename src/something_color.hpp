@@ -21,4 +21,14 @@ struct RGBA
 RGBA sdl_to_rgba(SDL_Color sdl_color);
 SDL_Color rgba_to_sdl(RGBA rgba);
 
+// NOTE: `a` over `b`
+RGBA mix_colors(RGBA b, RGBA a);
+
+// NOTE: batched versions of HSLA::to_rgba(), mix_colors() and
+// rgba_to_sdl() for converting whole arrays of colors at once
+// (particles, entity shades and such).
+void hsla_to_rgba_batch(const HSLA *hslas, RGBA *rgbas, size_t count);
+void mix_colors_batch(const RGBA *bs, const RGBA *as, RGBA *mixed, size_t count);
+void rgba_to_sdl_batch(const RGBA *rgbas, SDL_Color *sdl_colors, size_t count);
+
 #endif  // SOMETHING_COLOR_HPP_
@@ -96,6 +96,8 @@ void command_set(Game *game, String_View args)
         game->console.println("Variable `", varname, "` has unknown type");
     }
     }
+
+    config_override((size_t) varindex);
 }
 
 void command_reload(Game *game, String_View)
@@ -105,7 +107,8 @@ void command_reload(Game *game, String_View)
         game->console.println(VARS_CONF_FILE_PATH, ":", result.line, ": ", result.message);
         game->popup.notify(FONT_FAILURE_COLOR, "%s:%d: %s", VARS_CONF_FILE_PATH, result.line, result.message);
     } else {
-        game->console.println("Reloaded config file `", VARS_CONF_FILE_PATH, "`");
+        game->console.println("Reloaded config file `", VARS_CONF_FILE_PATH, "`, ",
+                              config_changed_count, " variable(s) changed");
         game->popup.notify(FONT_SUCCESS_COLOR, "Reloaded config file\n\n%s", VARS_CONF_FILE_PATH);
     }
 }
@@ -123,26 +126,16 @@ void command_save_room(Game *game, String_View)
         }
     }
     if(lock) {
-        size_t tile_index = 0;
-        for (int y = lock->y; y < lock->y + ROOM_HEIGHT; ++y) {
-            for (int x = lock->x; x < lock->x + ROOM_WIDTH; ++x) {
-                room_to_save[tile_index] = game->grid.tiles[y][x];
-                tile_index++;
-            }
-        }
-
         const int rooms_count = game->get_rooms_count();
 
         char filepath[256];
         snprintf(filepath, sizeof(filepath), "./assets/rooms/room-%d.bin", rooms_count);
-        FILE *f = fopen(filepath, "wb");
-        if (!f) {
-            game->console.println("Could not open file `", filepath, "`: ",
-                    strerror(errno));
+        const int err = game->grid.save_room_to_file(filepath, *lock);
+        if (err != 0) {
+            game->console.println("Could not save file `", filepath, "`: ",
+                    strerror(err));
             return;
         }
-        fwrite(room_to_save, sizeof(room_to_save[0]), ROOM_HEIGHT * ROOM_WIDTH, f);
-        fclose(f);
 
         game->console.println("New room is saved");
     } else {
@@ -163,3 +156,220 @@ void command_history(Game *game, String_View)
     }
     game->console.println("--------------------");
 }
+
+void command_bench_color(Game *game, String_View)
+{
+    const size_t BENCH_COLORS_COUNT = 1024;
+    const int BENCH_ITERATIONS = 1000;
+
+    static HSLA hslas[BENCH_COLORS_COUNT];
+    static RGBA rgbas[BENCH_COLORS_COUNT];
+    static RGBA mixed[BENCH_COLORS_COUNT];
+    static SDL_Color sdl_colors[BENCH_COLORS_COUNT];
+
+    // NOTE: not one of the game streams, the benchmark must not change
+    // the simulation
+    Rng rng = make_rng(0, 0);
+    for (size_t i = 0; i < BENCH_COLORS_COUNT; ++i) {
+        hslas[i] = {
+            rng.range(-30.0f, 390.0f),
+            rng.range(0.0f, 1.0f),
+            rng.range(0.0f, 1.0f),
+            rng.range(0.0f, 1.0f)
+        };
+    }
+
+    const float ns_per_tick = 1e9f / (float) SDL_GetPerformanceFrequency();
+    const float colors_total = (float) (BENCH_COLORS_COUNT * BENCH_ITERATIONS);
+
+    Uint64 begin = SDL_GetPerformanceCounter();
+    for (int iteration = 0; iteration < BENCH_ITERATIONS; ++iteration) {
+        for (size_t i = 0; i < BENCH_COLORS_COUNT; ++i) {
+            rgbas[i] = hslas[i].to_rgba();
+        }
+    }
+    const float hsla_scalar = (float) (SDL_GetPerformanceCounter() - begin) * ns_per_tick / colors_total;
+
+    begin = SDL_GetPerformanceCounter();
+    for (int iteration = 0; iteration < BENCH_ITERATIONS; ++iteration) {
+        hsla_to_rgba_batch(hslas, rgbas, BENCH_COLORS_COUNT);
+    }
+    const float hsla_batch = (float) (SDL_GetPerformanceCounter() - begin) * ns_per_tick / colors_total;
+
+    // NOTE: every color over the one next to it
+    begin = SDL_GetPerformanceCounter();
+    for (int iteration = 0; iteration < BENCH_ITERATIONS; ++iteration) {
+        for (size_t i = 0; i + 1 < BENCH_COLORS_COUNT; ++i) {
+            mixed[i] = mix_colors(rgbas[i + 1], rgbas[i]);
+        }
+    }
+    const float mix_scalar = (float) (SDL_GetPerformanceCounter() - begin) * ns_per_tick / colors_total;
+
+    begin = SDL_GetPerformanceCounter();
+    for (int iteration = 0; iteration < BENCH_ITERATIONS; ++iteration) {
+        mix_colors_batch(rgbas + 1, rgbas, mixed, BENCH_COLORS_COUNT - 1);
+    }
+    const float mix_batch = (float) (SDL_GetPerformanceCounter() - begin) * ns_per_tick / colors_total;
+
+    begin = SDL_GetPerformanceCounter();
+    for (int iteration = 0; iteration < BENCH_ITERATIONS; ++iteration) {
+        for (size_t i = 0; i < BENCH_COLORS_COUNT; ++i) {
+            sdl_colors[i] = rgba_to_sdl(rgbas[i]);
+        }
+    }
+    const float sdl_scalar = (float) (SDL_GetPerformanceCounter() - begin) * ns_per_tick / colors_total;
+
+    begin = SDL_GetPerformanceCounter();
+    for (int iteration = 0; iteration < BENCH_ITERATIONS; ++iteration) {
+        rgba_to_sdl_batch(rgbas, sdl_colors, BENCH_COLORS_COUNT);
+    }
+    const float sdl_batch = (float) (SDL_GetPerformanceCounter() - begin) * ns_per_tick / colors_total;
+
+    game->console.println("HSLA -> RGBA: scalar ", hsla_scalar, " ns, batch ", hsla_batch, " ns per color");
+    game->console.println("RGBA mix:     scalar ", mix_scalar, " ns, batch ", mix_batch, " ns per color");
+    game->console.println("RGBA -> SDL:  scalar ", sdl_scalar, " ns, batch ", sdl_batch, " ns per color");
+}
+
+void command_music(Game *game, String_View args)
+{
+    args = args.trim();
+
+    if (args.count == 0) {
+        if (game->mixer.music.file == NULL) {
+            game->console.println("No music is playing");
+        } else {
+            game->console.println("Music channels: ", game->mixer.music.channels,
+                                  ", underruns: ", SDL_AtomicGet(&game->mixer.music.underruns));
+        }
+        return;
+    }
+
+    if (args == "stop"_sv) {
+        game->mixer.stop_music();
+        return;
+    }
+
+    char file_path[256];
+    snprintf(file_path, sizeof(file_path), "%.*s", (int) args.count, args.data);
+    if (!game->mixer.play_music(file_path, SOUND_MUSIC_GAIN)) {
+        game->console.println("Could not stream `", args, "`. See stderr for details.");
+    }
+}
+
+void command_audio_stats(Game *game, String_View args)
+{
+    Mixer_Stats *stats = &game->mixer.stats;
+
+    if (args.trim() == "reset"_sv) {
+        stats->reset();
+        game->console.println("Audio stats are reset");
+        return;
+    }
+
+    game->console.println("Callbacks: ", SDL_AtomicGet(&stats->callbacks));
+    game->console.println("Duration: ", SDL_AtomicGet(&stats->duration_us),
+                          " us (max ", SDL_AtomicGet(&stats->max_duration_us),
+                          " us) of ", SDL_AtomicGet(&stats->period_us), " us period");
+    game->console.println("Active voices: ", SDL_AtomicGet(&stats->active_voices),
+                          "/", SAMPLE_MIXER_CAPACITY);
+    game->console.println("Dropped: ", SDL_AtomicGet(&stats->dropped),
+                          ", culled: ", SDL_AtomicGet(&stats->culled));
+    game->console.println("Late: ", SDL_AtomicGet(&stats->late),
+                          ", overruns: ", SDL_AtomicGet(&stats->overruns),
+                          ", music underruns: ", SDL_AtomicGet(&game->mixer.music.underruns));
+    for (size_t i = 0; i < MIXER_STATS_HISTOGRAM_SIZE; ++i) {
+        game->console.println("  ", i * 100 / MIXER_STATS_HISTOGRAM_SIZE, "%",
+                              i + 1 < MIXER_STATS_HISTOGRAM_SIZE ? "" : "+",
+                              " of period: ", SDL_AtomicGet(&stats->histogram[i]));
+    }
+}
+
+void command_profile_dump(Game *game, String_View args)
+{
+    args = args.trim();
+
+    char file_path[256];
+    if (args.count == 0) {
+        snprintf(file_path, sizeof(file_path), "%s", PROFILER_TRACE_FILE_PATH);
+    } else {
+        snprintf(file_path, sizeof(file_path), "%.*s", (int) args.count, args.data);
+    }
+
+    const int err = profile_dump_chrome_trace(file_path);
+    if (err != 0) {
+        game->console.println("Could not save file `", file_path, "`: ", strerror(err));
+        return;
+    }
+
+    game->console.println("Saved the profile to ", file_path);
+}
+
+void command_render_stats(Game *game, String_View args)
+{
+    args = args.trim();
+    const auto subcommand = args.chop_word();
+    args = args.trim();
+
+    if (subcommand == "export"_sv) {
+        char file_path[256];
+        if (args.count == 0) {
+            snprintf(file_path, sizeof(file_path), "%s", RENDER_STATS_FILE_PATH);
+        } else {
+            snprintf(file_path, sizeof(file_path), "%.*s", (int) args.count, args.data);
+        }
+
+        if (!render_stats.start_export(file_path)) {
+            game->console.println("Could not open file `", file_path, "`: ", strerror(errno));
+            return;
+        }
+
+        game->console.println("Logging the render stats of every frame to ", file_path);
+        return;
+    }
+
+    if (subcommand == "stop"_sv) {
+        if (render_stats.output == NULL) {
+            game->console.println("The render stats are not being logged");
+            return;
+        }
+
+        render_stats.stop_export();
+        game->console.println("Stopped logging the render stats after ", render_stats.frames, " frames");
+        return;
+    }
+
+    if (subcommand.count > 0) {
+        game->console.println("Unknown subcommand `", subcommand, "`");
+        return;
+    }
+
+    for (size_t i = 0; i <= RENDER_SUBSYSTEMS_COUNT; ++i) {
+        const Render_Counters counters =
+            i < RENDER_SUBSYSTEMS_COUNT ? render_stats.last[i] : render_stats.last_total();
+        game->console.println(i < RENDER_SUBSYSTEMS_COUNT ? render_subsystem_names[i] : "total",
+                              ": draws ", counters.draw_calls,
+                              ", states ", counters.state_changes,
+                              ", quads ", counters.quads);
+    }
+}
+
+void command_memory(Game *game, String_View args)
+{
+    if (args.trim() == "reset"_sv) {
+        memset(memory_stats.peaks, 0, sizeof(memory_stats.peaks));
+        memory_stats.total_peak = 0;
+        memory_stats.sample(game);
+        game->console.println("Memory peaks are reset");
+        return;
+    }
+
+    memory_stats.sample(game);
+
+    char row[128];
+    memory_stats.format_header(row, sizeof(row));
+    game->console.println(row);
+    for (size_t i = 0; i <= MEMORY_SUBSYSTEMS_COUNT; ++i) {
+        memory_stats.format_row(i, row, sizeof(row));
+        game->console.println(row);
+    }
+}
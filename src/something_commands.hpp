@@ -13,8 +13,13 @@ void command_set(Game *game, String_View args);
 void command_reload(Game *game, String_View args);
 #endif // SOMETHING_RELEASE
 void command_save_room(Game *game, String_View args);
-Tile room_to_save[ROOM_WIDTH * ROOM_HEIGHT];
 void command_history(Game *game, String_View args);
+void command_bench_color(Game *game, String_View args);
+void command_music(Game *game, String_View args);
+void command_audio_stats(Game *game, String_View args);
+void command_profile_dump(Game *game, String_View args);
+void command_render_stats(Game *game, String_View args);
+void command_memory(Game *game, String_View args);
 
 struct Command
 {
@@ -35,6 +40,12 @@ const Command commands[] = {
 #endif // SOMETHING_RELEASE
     {"save_room"_sv,   "Save current room as new file"_sv,    command_save_room},
     {"history"_sv,     "Print the history of the Console"_sv, command_history},
+    {"bench_color"_sv, "Benchmark scalar vs batched color conversion"_sv, command_bench_color},
+    {"music"_sv,       "music <file.wav> | music stop | music -- stream music from disk"_sv, command_music},
+    {"audio_stats"_sv, "Print the audio callback stats (audio_stats reset -- clear them)"_sv, command_audio_stats},
+    {"profile_dump"_sv, "profile_dump [file.json] -- dump the profiler zones as a Chrome trace"_sv, command_profile_dump},
+    {"render_stats"_sv, "Print the renderer calls of the last frame (render_stats export [file.csv] | render_stats stop -- log them every frame)"_sv, command_render_stats},
+    {"memory"_sv,      "Print the memory used by every subsystem (memory reset -- clear the peaks)"_sv, command_memory},
 };
 const size_t commands_count = sizeof(commands) / sizeof(commands[0]);
 
@@ -6,6 +6,8 @@
 
 void Console::render(SDL_Renderer *renderer, Bitmap_Font *font)
 {
+    Render_Subsystem_Scope scope(RENDER_SUBSYSTEM_CONSOLE);
+
     if (slide_position > 0.0f) {
         const float CONSOLE_EDIT_FIELD_ROW = 1.0f;
         const float CONSOLE_HEIGHT = BITMAP_FONT_CHAR_HEIGHT * CONSOLE_FONT_SIZE * (CONSOLE_VISIBLE_ROWS + CONSOLE_EDIT_FIELD_ROW);
@@ -83,6 +85,7 @@ void Console::handle_event(SDL_Event *event, Game *game)
                     assert(varindex >= 0);
                     assert(config_types[varindex] == CONFIG_TYPE_FLOAT);
                     config_values[varindex].float_value += CONSOLE_FONT_SIZE_STEP;
+                    config_override((size_t) varindex);
                 }
             } break;
 
@@ -92,6 +95,7 @@ void Console::handle_event(SDL_Event *event, Game *game)
                     assert(varindex >= 0);
                     assert(config_types[varindex] == CONFIG_TYPE_FLOAT);
                     config_values[varindex].float_value -= CONSOLE_FONT_SIZE_STEP;
+                    config_override((size_t) varindex);
                 }
             } break;
             }
@@ -8,22 +8,11 @@ void Entity::kill()
     }
 }
 
-RGBA mix_colors(RGBA b32, RGBA a32)
+void Entity::render(SDL_Renderer *renderer, Camera camera,
+                    Frame_Animat_Playback playback, SDL_Color shade) const
 {
-    const float r_alpha = a32.a + b32.a * (1.0f - a32.a);
+    Render_Subsystem_Scope scope(RENDER_SUBSYSTEM_ENTITIES);
 
-    RGBA r = {};
-
-    r.r = (a32.r * a32.a + b32.r * b32.a * (1.0f - a32.a)) / r_alpha;
-    r.g = (a32.g * a32.a + b32.g * b32.a * (1.0f - a32.a)) / r_alpha;
-    r.b = (a32.b * a32.a + b32.b * b32.a * (1.0f - a32.a)) / r_alpha;
-    r.a = r_alpha;
-
-    return r;
-}
-
-void Entity::render(SDL_Renderer *renderer, Camera camera, RGBA shade) const
-{
     const SDL_RendererFlip flip =
         gun_dir.x > 0.0f ?
         SDL_FLIP_NONE :
@@ -66,51 +55,20 @@ void Entity::render(SDL_Renderer *renderer, Camera camera, RGBA shade) const
                 ENTITY_LIVEBAR_HEIGHT
             };
             if (percent > 0.75f) {
-                const SDL_Color entity_livebar_full_color = rgba_to_sdl(ENTITY_LIVEBAR_FULL_COLOR);
-                sec(SDL_SetRenderDrawColor(
-                        renderer,
-                        entity_livebar_full_color.r,
-                        entity_livebar_full_color.g,
-                        entity_livebar_full_color.b,
-                        entity_livebar_full_color.a));
+                render_draw_color(renderer, rgba_to_sdl(ENTITY_LIVEBAR_FULL_COLOR));
             } else if (0.25f < percent && percent < 0.75f) {
-                const SDL_Color entity_livebar_half_color = rgba_to_sdl(ENTITY_LIVEBAR_HALF_COLOR);
-                sec(SDL_SetRenderDrawColor(
-                        renderer,
-                        entity_livebar_half_color.r,
-                        entity_livebar_half_color.g,
-                        entity_livebar_half_color.b,
-                        entity_livebar_half_color.a));
+                render_draw_color(renderer, rgba_to_sdl(ENTITY_LIVEBAR_HALF_COLOR));
             } else {
-                const SDL_Color entity_livebar_low_color = rgba_to_sdl(ENTITY_LIVEBAR_LOW_COLOR);
-                sec(SDL_SetRenderDrawColor(
-                        renderer,
-                        entity_livebar_low_color.r,
-                        entity_livebar_low_color.g,
-                        entity_livebar_low_color.b,
-                        entity_livebar_low_color.a));
+                render_draw_color(renderer, rgba_to_sdl(ENTITY_LIVEBAR_LOW_COLOR));
             }
             const auto rect_border = rectf_for_sdl(camera.to_screen(livebar_border));
-            sec(SDL_RenderDrawRect(renderer, &rect_border));
+            render_draw_rect(renderer, &rect_border);
             const auto rect_remain = rectf_for_sdl(camera.to_screen(livebar_remain));
-            sec(SDL_RenderFillRect(renderer, &rect_remain));
+            render_fill_rect(renderer, &rect_remain);
         }
 
-        RGBA effective_flash_color = flash_color;
-        effective_flash_color.a = flash_alpha;
-
         // Render the character
-        switch (alive_state) {
-        case Alive_State::Idle: {
-            assets.animats[idle.unwrap].unwrap.render(renderer, camera.to_screen(texbox), flip,
-                                                      mix_colors(shade, effective_flash_color));
-        } break;
-
-        case Alive_State::Walking: {
-            assets.animats[walking.unwrap].unwrap.render(renderer, camera.to_screen(texbox), flip,
-                                                         mix_colors(shade, effective_flash_color));
-        } break;
-        }
+        playback.render(renderer, camera.to_screen(texbox), flip, shade);
 
         // Render the gun
         // TODO(#59): Proper gun rendering
@@ -124,17 +82,24 @@ void Entity::render(SDL_Renderer *renderer, Camera camera, RGBA shade) const
 
     case Entity_State::Poof: {
         Rectf texbox = poof_animat.transform_rect(texbox_local, pos);
-        // TODO(#151): Poof state loses last alive frame
-        //   Previous animation implementation was capturing texture of last alive state.
-        //   So if entity was shot in running pose it was squashing in this position.
-        //   So there's no sudden graphical switch to idle texture.
-        assets.animats[idle.unwrap].unwrap.render(renderer, camera.to_screen(texbox), flip, shade);
+        // NOTE: the playback is paused while the entity is in the
+        // Poof state, so it squashes in its last alive frame.
+        playback.render(renderer, camera.to_screen(texbox), flip, shade);
     } break;
 
     case Entity_State::Ded: {} break;
     }
 }
 
+// NOTE: only the alive entities flash. The rest get a transparent
+// color, so mixing it into the shade leaves the shade as is.
+RGBA Entity::effective_flash_color() const
+{
+    RGBA result = flash_color;
+    result.a = state == Entity_State::Alive ? flash_alpha : 0.0f;
+    return result;
+}
+
 void Entity::render_debug(SDL_Renderer *renderer, Camera camera) const
 {
     if (state == Entity_State::Alive) {
@@ -147,7 +112,7 @@ void Entity::render_debug(SDL_Renderer *renderer, Camera camera) const
                     pos +
                     vec2(hitbox_local.x, hitbox_local.y) +
                     vec2(cols * step_x, rows * step_y));
-                SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
+                render_draw_color(renderer, {255, 0, 0, 255});
                 const int PROBE_SIZE = 10;
                 SDL_Rect rect = {
                     (int)t.x - PROBE_SIZE / 2,
@@ -155,41 +120,28 @@ void Entity::render_debug(SDL_Renderer *renderer, Camera camera) const
                     PROBE_SIZE,
                     PROBE_SIZE
                 };
-                sec(SDL_RenderFillRect(renderer, &rect));
+                render_fill_rect(renderer, &rect);
             }
         }
     }
 }
 
-HSLA get_particle_color_for_tile(Tile_Grid *grid, Vec2f pos)
+HSLA get_particle_color_for_tile(Tile_Grid *grid, Vec2f pos, Rng *rng)
 {
-    const auto tile_sprite = tile_defs[*grid->tile_at_abs(pos + vec2(0.0f, TILE_SIZE * 0.5f))].top_texture;
-    const auto surface = assets.textures[tile_sprite.texture_index.unwrap].unwrap.surface;
-    const auto x = rand() % tile_sprite.srcrect.w;
-    sec(SDL_LockSurface(surface));
-    HSLA result = {};
-    {
-        assert(surface->format->format == SDL_PIXELFORMAT_RGBA32);
-        const auto pixel = *(Uint32*) ((uint8_t *) surface->pixels + tile_sprite.srcrect.y * surface->pitch + (tile_sprite.srcrect.x + x) * sizeof(Uint32));
-        SDL_Color color = {};
-        SDL_GetRGBA(
-            pixel,
-            surface->format,
-            &color.r,
-            &color.g,
-            &color.b,
-            &color.a);
-        result = sdl_to_rgba(color).to_hsla();
-    }
-    SDL_UnlockSurface(surface);
-    return result;
+    const auto coord = grid->abs_to_tile_coord(pos + vec2(0.0f, TILE_SIZE * 0.5f));
+    if (!grid->is_tile_coord_inbounds(coord)) return {};
+
+    const auto &tile_def = tile_defs[grid->get_tile(coord)];
+    if (tile_def.particle_palette_count == 0) return {};
+
+    return tile_def.particle_palette[rng->below((uint32_t) tile_def.particle_palette_count)];
 }
 
-void Entity::update(float dt, Sample_Mixer *mixer, Tile_Grid *grid)
+void Entity::update(float dt, Sample_Mixer *mixer, Tile_Grid *grid, Rng *particles_rng, Rng *sounds_rng)
 {
     if (state == Entity_State::Alive && alive_state == Alive_State::Walking && ground(grid)) {
         particles.state = Particles::EMITTING;
-        particles.current_color = get_particle_color_for_tile(grid, feet());
+        particles.current_color = get_particle_color_for_tile(grid, feet(), particles_rng);
     } else {
         particles.state = Particles::DISABLED;
     }
@@ -199,7 +151,7 @@ void Entity::update(float dt, Sample_Mixer *mixer, Tile_Grid *grid)
     }
 
     particles.source = feet();
-    particles.update(dt, grid);
+    particles.update(dt, grid, particles_rng);
 
     switch (state) {
     case Entity_State::Alive: {
@@ -229,11 +181,12 @@ void Entity::update(float dt, Sample_Mixer *mixer, Tile_Grid *grid)
                 jump_state = Jump_State::Jump;
                 has_jumped = true;
                 vel.y = ENTITY_GRAVITY * -0.6f;
-                mixer->play_sample(assets.sounds[jump_samples[rand() % 2].unwrap].unwrap);
+                mixer->play_sample_at(
+                    assets.sounds[jump_samples[sounds_rng->below(2)].unwrap].unwrap,
+                    {SOUND_JUMP_PRIORITY, SOUND_JUMP_MAX_INSTANCES, 1.0f},
+                    pos);
                 if (ground(grid)) {
-                    for (int i = 0; i < ENTITY_JUMP_PARTICLE_BURST; ++i) {
-                        particles.push(rand_float_range(PARTICLE_JUMP_VEL_LOW, PARTICLE_JUMP_VEL_HIGH));
-                    }
+                    particles.push_burst(ENTITY_JUMP_PARTICLE_BURST, PARTICLE_JUMP_VEL_LOW, PARTICLE_JUMP_VEL_HIGH, particles_rng);
                 }
             }
             break;
@@ -248,7 +201,6 @@ void Entity::update(float dt, Sample_Mixer *mixer, Tile_Grid *grid)
 
         switch (alive_state) {
         case Alive_State::Idle:
-            assets.animats[idle.unwrap].unwrap.update(dt);
             break;
 
         case Alive_State::Walking:
@@ -264,8 +216,6 @@ void Entity::update(float dt, Sample_Mixer *mixer, Tile_Grid *grid)
                               ENTITY_SPEED);
             } break;
             }
-
-            assets.animats[walking.unwrap].unwrap.update(dt);
             break;
         }
     } break;
@@ -281,6 +231,28 @@ void Entity::update(float dt, Sample_Mixer *mixer, Tile_Grid *grid)
     }
 }
 
+void Entity::update_animat_playback(Frame_Animat_Playback *playback) const
+{
+    switch (state) {
+    case Entity_State::Alive: {
+        switch (alive_state) {
+        case Alive_State::Idle:
+            playback->play(idle);
+            break;
+
+        case Alive_State::Walking:
+            playback->play(walking);
+            break;
+        }
+    } break;
+
+    case Entity_State::Poof:
+    case Entity_State::Ded: {
+        playback->paused = true;
+    } break;
+    }
+}
+
 void Entity::point_gun_at(Vec2f target)
 {
     gun_dir = target - pos;
@@ -315,11 +287,11 @@ Entity player_entity(Vec2f pos)
     entity.hitbox_local.x = entity.hitbox_local.w * -0.5f;
     entity.hitbox_local.y = entity.hitbox_local.h * -0.5f;
 
-    entity.idle            = assets.get_animat_by_id_or_panic("PLAYER_ANIMAT"_sv);
-    entity.walking         = assets.get_animat_by_id_or_panic("PLAYER_ANIMAT"_sv);
-    entity.jump_samples[0] = assets.get_sound_by_id_or_panic("JUMP1_SOUND"_sv);
-    entity.jump_samples[1] = assets.get_sound_by_id_or_panic("JUMP2_SOUND"_sv);
-    entity.shoot_sample    = assets.get_sound_by_id_or_panic("PEW_SOUND"_sv);
+    entity.idle            = assets.handles.player_animat;
+    entity.walking         = assets.handles.player_animat;
+    entity.jump_samples[0] = assets.handles.jump1_sound;
+    entity.jump_samples[1] = assets.handles.jump2_sound;
+    entity.shoot_sample    = assets.handles.pew_sound;
 
     entity.lives = ENTITY_INITIAL_LIVES;
     entity.state = Entity_State::Alive;
@@ -368,10 +340,10 @@ Entity ice_golem_entity(Vec2f pos)
     entity.hitbox_local.x = entity.hitbox_local.w * -0.5f;
     entity.hitbox_local.y = entity.hitbox_local.h * -0.5f;
 
-    entity.idle = assets.get_animat_by_id_or_panic("ICE_GOLEM_IDLE_ANIMAT"_sv);
-    entity.walking = assets.get_animat_by_id_or_panic("ICE_GOLEM_WALKING_ANIMAT"_sv);
-    entity.jump_samples[0] = assets.get_sound_by_id_or_panic("JUMP1_SOUND"_sv);
-    entity.jump_samples[1] = assets.get_sound_by_id_or_panic("JUMP2_SOUND"_sv);
+    entity.idle = assets.handles.ice_golem_idle_animat;
+    entity.walking = assets.handles.ice_golem_walking_animat;
+    entity.jump_samples[0] = assets.handles.jump1_sound;
+    entity.jump_samples[1] = assets.handles.jump2_sound;
 
     entity.lives = ENTITY_INITIAL_LIVES;
     entity.state = Entity_State::Alive;
@@ -421,10 +393,10 @@ Entity golem_entity(Vec2f pos)
     entity.hitbox_local.y = entity.hitbox_local.h * -0.5f;
 
 
-    entity.idle = assets.get_animat_by_id_or_panic("DIRT_GOLEM_ANIMAT"_sv);
-    entity.walking = assets.get_animat_by_id_or_panic("DIRT_GOLEM_ANIMAT"_sv);
-    entity.jump_samples[0] = assets.get_sound_by_id_or_panic("JUMP1_SOUND"_sv);
-    entity.jump_samples[1] = assets.get_sound_by_id_or_panic("JUMP2_SOUND"_sv);
+    entity.idle = assets.handles.dirt_golem_animat;
+    entity.walking = assets.handles.dirt_golem_animat;
+    entity.jump_samples[0] = assets.handles.jump1_sound;
+    entity.jump_samples[1] = assets.handles.jump2_sound;
 
     entity.lives = ENTITY_INITIAL_LIVES;
     entity.state = Entity_State::Alive;
@@ -470,10 +442,10 @@ Entity enemy_entity(Vec2f pos)
     entity.hitbox_local.x = entity.hitbox_local.w * -0.5f;
     entity.hitbox_local.y = entity.hitbox_local.h * -0.5f;
 
-    entity.idle            = assets.get_animat_by_id_or_panic("ENEMY_IDLE_ANIMAT"_sv);
-    entity.walking         = assets.get_animat_by_id_or_panic("ENEMY_WALKING_ANIMAT"_sv);
-    entity.jump_samples[0] = assets.get_sound_by_id_or_panic("JUMP1_SOUND"_sv);
-    entity.jump_samples[1] = assets.get_sound_by_id_or_panic("JUMP2_SOUND"_sv);
+    entity.idle            = assets.handles.enemy_idle_animat;
+    entity.walking         = assets.handles.enemy_walking_animat;
+    entity.jump_samples[0] = assets.handles.jump1_sound;
+    entity.jump_samples[1] = assets.handles.jump2_sound;
 
     entity.lives = ENTITY_INITIAL_LIVES;
     entity.state = Entity_State::Alive;
@@ -101,10 +101,14 @@ struct Entity
         return hitbox;
     }
 
+    // NOTE: `shade` is already mixed with the flash, see Game::render()
     void render(SDL_Renderer *renderer, Camera camera,
-                RGBA shade = {0, 0, 0, 0}) const;
+                Frame_Animat_Playback playback,
+                SDL_Color shade) const;
+    RGBA effective_flash_color() const;
     void render_debug(SDL_Renderer *renderer, Camera camera) const;
-    void update(float dt, Sample_Mixer *mixer, Tile_Grid *grid);
+    void update(float dt, Sample_Mixer *mixer, Tile_Grid *grid, Rng *particles_rng, Rng *sounds_rng);
+    void update_animat_playback(Frame_Animat_Playback *playback) const;
     void point_gun_at(Vec2f target);
     void jump();
     void flash(RGBA color);
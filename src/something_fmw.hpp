@@ -3,10 +3,51 @@
 
 // NOTE: FMW stands for File Modification Watcher
 
+const size_t FMW_WATCHES_CAPACITY = 64;
+const size_t FMW_EVENTS_CAPACITY = 64;
+const size_t FMW_PATH_CAPACITY = 256;
+
 struct Fmw;
 
-Fmw *fmw_init(const char *filepath);
+struct Fmw_Event
+{
+    // NOTE: what fmw_watch() returned for the file or the directory
+    int watch;
+    // NOTE: the path of the file that changed. For a directory watch
+    // it is the path of the file inside of that directory.
+    char path[FMW_PATH_CAPACITY];
+};
+
+Fmw *fmw_init();
 void fmw_free(Fmw *fmw);
-bool fmw_poll(Fmw *fmw);
+// NOTE: watches a single file or all of the files in a directory.
+// Returns -1 if the path could not be watched.
+int fmw_watch(Fmw *fmw, const char *path);
+// NOTE: drains everything that happened since the previous call and
+// reports every path at most once. Editors usually save a file in
+// several writes, which become a single event per frame this way.
+size_t fmw_poll(Fmw *fmw, Fmw_Event *events, size_t events_capacity);
+
+inline void fmw_push_event(Fmw_Event *events, size_t *events_count, size_t events_capacity,
+                           int watch, const char *dir, const char *name)
+{
+    char path[FMW_PATH_CAPACITY];
+    if (name == NULL || *name == '\0') {
+        snprintf(path, sizeof(path), "%s", dir);
+    } else {
+        const size_t n = strlen(dir);
+        snprintf(path, sizeof(path), "%s%s%s", dir, n > 0 && dir[n - 1] == '/' ? "" : "/", name);
+    }
+
+    for (size_t i = 0; i < *events_count; ++i) {
+        if (strcmp(events[i].path, path) == 0) return;
+    }
+
+    if (*events_count >= events_capacity) return;
+
+    events[*events_count].watch = watch;
+    memcpy(events[*events_count].path, path, sizeof(path));
+    *events_count += 1;
+}
 
 #endif  // SOMETHING_FMW_HPP_
@@ -2,7 +2,7 @@
 
 struct Fmw {};
 
-Fmw *fmw_init(const char *)
+Fmw *fmw_init()
 {
     return NULL;
 }
@@ -11,7 +11,12 @@ void fmw_free(Fmw *)
 {
 }
 
-bool fmw_poll(Fmw *)
+int fmw_watch(Fmw *, const char *)
 {
-    return false;
+    return -1;
+}
+
+size_t fmw_poll(Fmw *, Fmw_Event *, size_t)
+{
+    return 0;
 }
@@ -1,17 +1,38 @@
 #include <sys/inotify.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 #include "something_fmw.hpp"
 
+struct Fmw_Watch
+{
+    int wd;
+    bool is_dir;
+    char path[FMW_PATH_CAPACITY];
+};
+
 struct Fmw
 {
     int fd;
-    int wd;
+    Fmw_Watch watches[FMW_WATCHES_CAPACITY];
+    size_t watches_count;
 };
 
-Fmw *fmw_init(const char *filepath)
+static uint32_t fmw_mask(bool is_dir)
+{
+    // NOTE: editors often save by writing a temporary file and
+    // renaming it over the original one, which removes the watch of
+    // the original file. Such watches are added back in fmw_poll().
+    return is_dir
+        ? IN_CLOSE_WRITE | IN_MOVED_TO
+        : IN_MODIFY | IN_DELETE_SELF | IN_MOVE_SELF;
+}
+
+Fmw *fmw_init()
 {
     Fmw *fmw = (Fmw*) malloc(sizeof(Fmw));
+    assert(fmw != NULL);
+    memset(fmw, 0, sizeof(*fmw));
 
     fmw->fd = inotify_init1(IN_NONBLOCK);
     if (fmw->fd == -1) {
@@ -19,12 +40,6 @@ Fmw *fmw_init(const char *filepath)
         abort();
     }
 
-    fmw->wd = inotify_add_watch(fmw->fd, filepath, IN_MODIFY);
-    if (fmw->wd == -1) {
-        println(stderr, "inotify_add_watch() failed: ", strerror(errno));
-        abort();
-    }
-
     return fmw;
 }
 
@@ -34,23 +49,80 @@ void fmw_free(Fmw *fmw)
     free(fmw);
 }
 
-bool fmw_poll(Fmw *fmw)
+int fmw_watch(Fmw *fmw, const char *path)
 {
-    inotify_event event = {};
-    char buffer[1024];
+    assert(fmw->watches_count < FMW_WATCHES_CAPACITY);
 
-    auto n = read(fmw->fd, &event, sizeof(event));
-    if (n != -1 || errno != EAGAIN) {
-        assert(n == sizeof(event));
+    struct stat path_stat = {};
+    if (stat(path, &path_stat) < 0) {
+        println(stderr, "Could not watch `", path, "`: ", strerror(errno));
+        return -1;
+    }
 
-        // Skiping the name
-        size_t m = event.len;
-        while (m > 0) {
-            m -= read(fmw->fd, buffer, min(sizeof(buffer), m));
+    Fmw_Watch *watch = &fmw->watches[fmw->watches_count];
+    watch->is_dir = S_ISDIR(path_stat.st_mode);
+    snprintf(watch->path, sizeof(watch->path), "%s", path);
+    watch->wd = inotify_add_watch(fmw->fd, path, fmw_mask(watch->is_dir));
+    if (watch->wd == -1) {
+        println(stderr, "inotify_add_watch() failed: ", strerror(errno));
+        return -1;
+    }
+
+    return (int) fmw->watches_count++;
+}
+
+size_t fmw_poll(Fmw *fmw, Fmw_Event *events, size_t events_capacity)
+{
+    size_t events_count = 0;
+    alignas(inotify_event) char buffer[4096];
+
+    for (;;) {
+        const ssize_t n = read(fmw->fd, buffer, sizeof(buffer));
+        if (n == -1) {
+            if (errno == EAGAIN) break;
+            println(stderr, "Could not read inotify events: ", strerror(errno));
+            abort();
         }
 
-        return true;
+        for (ssize_t i = 0; i < n; ) {
+            const inotify_event *event = (const inotify_event *) (buffer + i);
+            i += (ssize_t) (sizeof(inotify_event) + event->len);
+
+            for (size_t j = 0; j < fmw->watches_count; ++j) {
+                Fmw_Watch *watch = &fmw->watches[j];
+                if (watch->wd != event->wd) continue;
+
+                if (event->mask & IN_IGNORED) {
+                    watch->wd = -1;
+                } else if (event->mask & IN_MOVE_SELF) {
+                    // NOTE: the watch would follow the file to its new
+                    // name, but we care about the old one
+                    inotify_rm_watch(fmw->fd, watch->wd);
+                    watch->wd = -1;
+                } else if (watch->is_dir) {
+                    if (event->len > 0) {
+                        fmw_push_event(events, &events_count, events_capacity,
+                                       (int) j, watch->path, event->name);
+                    }
+                } else if (event->mask & IN_MODIFY) {
+                    fmw_push_event(events, &events_count, events_capacity,
+                                   (int) j, watch->path, NULL);
+                }
+            }
+        }
+    }
+
+    for (size_t j = 0; j < fmw->watches_count; ++j) {
+        Fmw_Watch *watch = &fmw->watches[j];
+        if (watch->wd != -1) continue;
+
+        // NOTE: the file was replaced. It is a change as soon as the
+        // new one shows up.
+        watch->wd = inotify_add_watch(fmw->fd, watch->path, fmw_mask(watch->is_dir));
+        if (watch->wd != -1) {
+            fmw_push_event(events, &events_count, events_capacity, (int) j, watch->path, NULL);
+        }
     }
 
-    return false;
+    return events_count;
 }
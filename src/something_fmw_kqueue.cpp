@@ -1,19 +1,111 @@
 #include <fcntl.h>
 #include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
 #include <sys/time.h>
 #include <sys/event.h>
 
 #include "something_fmw.hpp"
 
-struct Fmw
+// NOTE: kqueue can only watch the files that are already open, so a
+// directory watch opens every file in the directory and the directory
+// itself. When the directory changes (a file was created or renamed
+// into it) it is rescanned for the files that are not open yet.
+const size_t FMW_FILES_CAPACITY = 512;
+const size_t FMW_KEVENTS_CAPACITY = 32;
+
+struct Fmw_Watch
 {
     int fd;
+    bool is_dir;
+    char path[FMW_PATH_CAPACITY];
+};
+
+struct Fmw_File
+{
+    int fd;
+    int watch;
+    char path[FMW_PATH_CAPACITY];
+};
+
+struct Fmw
+{
     int kq;
+    Fmw_Watch watches[FMW_WATCHES_CAPACITY];
+    size_t watches_count;
+    Fmw_File files[FMW_FILES_CAPACITY];
+    size_t files_count;
 };
 
-Fmw *fmw_init(const char *filepath)
+static int fmw_open(Fmw *fmw, const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) return -1;
+
+    struct kevent change;
+    EV_SET(&change, fd, EVFILT_VNODE, EV_ADD | EV_ENABLE | EV_CLEAR,
+           NOTE_DELETE | NOTE_EXTEND | NOTE_WRITE | NOTE_RENAME, 0, 0);
+    if (kevent(fmw->kq, &change, 1, NULL, 0, NULL) == -1) {
+        println(stderr, "kevent() failed: ", strerror(errno));
+        abort();
+    }
+
+    return fd;
+}
+
+// NOTE: opens the files of the directory that are not watched yet and
+// reports them as changed, because they are either new or replaced
+static void fmw_scan_dir(Fmw *fmw, int watch_index,
+                         Fmw_Event *events, size_t *events_count, size_t events_capacity)
+{
+    const Fmw_Watch *watch = &fmw->watches[watch_index];
+
+    DIR *dir = opendir(watch->path);
+    if (dir == NULL) return;
+    defer(closedir(dir));
+
+    for (struct dirent *d = readdir(dir); d != NULL; d = readdir(dir)) {
+        if (*d->d_name == '.') continue;
+
+        Fmw_Event probe = {};
+        size_t probe_count = 0;
+        fmw_push_event(&probe, &probe_count, 1, watch_index, watch->path, d->d_name);
+
+        struct stat file_stat = {};
+        if (stat(probe.path, &file_stat) < 0 || !S_ISREG(file_stat.st_mode)) continue;
+
+        Fmw_File *file = NULL;
+        for (size_t i = 0; i < fmw->files_count; ++i) {
+            if (strcmp(fmw->files[i].path, probe.path) == 0) {
+                file = &fmw->files[i];
+                break;
+            }
+        }
+
+        if (file != NULL && file->fd != -1) continue;
+
+        if (file == NULL) {
+            if (fmw->files_count >= FMW_FILES_CAPACITY) {
+                println(stderr, "[WARN] Too many watched files, not watching ", probe.path);
+                continue;
+            }
+            file = &fmw->files[fmw->files_count++];
+            file->watch = watch_index;
+            memcpy(file->path, probe.path, sizeof(probe.path));
+        }
+
+        file->fd = fmw_open(fmw, file->path);
+        if (file->fd != -1 && events != NULL) {
+            fmw_push_event(events, events_count, events_capacity, watch_index, file->path, NULL);
+        }
+    }
+}
+
+Fmw *fmw_init()
 {
     Fmw *fmw = (Fmw*) malloc(sizeof(Fmw));
+    assert(fmw != NULL);
+    memset(fmw, 0, sizeof(*fmw));
 
     fmw->kq = kqueue();
     if (fmw->kq == -1) {
@@ -21,45 +113,123 @@ Fmw *fmw_init(const char *filepath)
         abort();
     }
 
-    fmw->fd = open(filepath, O_RDONLY);
-    if (fmw->fd == -1) {
-        println(stderr, "open() failed: ", strerror(errno));
-        abort();
-    }
     return fmw;
 }
 
 void fmw_free(Fmw *fmw)
 {
+    for (size_t i = 0; i < fmw->files_count; ++i) {
+        if (fmw->files[i].fd != -1) close(fmw->files[i].fd);
+    }
+    for (size_t i = 0; i < fmw->watches_count; ++i) {
+        if (fmw->watches[i].fd != -1) close(fmw->watches[i].fd);
+    }
     close(fmw->kq);
-    close(fmw->fd);
     free(fmw);
 }
 
-bool fmw_poll(Fmw *fmw)
+int fmw_watch(Fmw *fmw, const char *path)
 {
-    struct kevent event;
-    struct kevent watch;
+    assert(fmw->watches_count < FMW_WATCHES_CAPACITY);
 
-    // set the event parameters
-    EV_SET(&watch, fmw->fd, EVFILT_VNODE, EV_ADD | EV_ENABLE | EV_ONESHOT,
-        NOTE_DELETE | NOTE_EXTEND | NOTE_WRITE, 0, 0);
+    struct stat path_stat = {};
+    if (stat(path, &path_stat) < 0) {
+        println(stderr, "Could not watch `", path, "`: ", strerror(errno));
+        return -1;
+    }
 
-    // setup a null timespec, to have a 0 timeout (ie. return immediately)
-    struct timespec tm = { };
+    const int watch_index = (int) fmw->watches_count;
+    Fmw_Watch *watch = &fmw->watches[watch_index];
+    watch->is_dir = S_ISDIR(path_stat.st_mode);
+    snprintf(watch->path, sizeof(watch->path), "%s", path);
+    watch->fd = fmw_open(fmw, path);
+    if (watch->fd == -1) {
+        println(stderr, "open() failed: ", strerror(errno));
+        return -1;
+    }
+    fmw->watches_count += 1;
 
-    // poll once.
-    int num_events = kevent(fmw->kq, &watch, 1, &event, 1, &tm);
+    if (watch->is_dir) {
+        fmw_scan_dir(fmw, watch_index, NULL, NULL, 0);
+    }
 
-    if (num_events == -1) {
-        println(stderr, "kevent() failed: ", strerror(errno));
-        abort();
+    return watch_index;
+}
+
+size_t fmw_poll(Fmw *fmw, Fmw_Event *events, size_t events_capacity)
+{
+    size_t events_count = 0;
+    struct kevent kevents[FMW_KEVENTS_CAPACITY];
+    // NOTE: a zero timeout, so kevent() returns immediately
+    struct timespec tm = {};
+    // NOTE: the directories that lost a file. The event of the
+    // directory itself may come before the one of the file in the same
+    // batch, so its rescan could have skipped the file that was still
+    // open at that point.
+    bool rescan[FMW_WATCHES_CAPACITY] = {};
+
+    for (;;) {
+        int n = kevent(fmw->kq, NULL, 0, kevents, (int) FMW_KEVENTS_CAPACITY, &tm);
+        if (n == -1) {
+            println(stderr, "kevent() failed: ", strerror(errno));
+            abort();
+        }
+        if (n == 0) break;
+
+        for (int i = 0; i < n; ++i) {
+            const int fd = (int) kevents[i].ident;
+            const bool gone = kevents[i].fflags & (NOTE_DELETE | NOTE_RENAME);
+
+            for (size_t j = 0; j < fmw->watches_count; ++j) {
+                Fmw_Watch *watch = &fmw->watches[j];
+                if (watch->fd != fd) continue;
+
+                if (watch->is_dir) {
+                    fmw_scan_dir(fmw, (int) j, events, &events_count, events_capacity);
+                } else if (gone) {
+                    // NOTE: not a change yet. There is nothing to
+                    // reload until the new file shows up below.
+                    close(watch->fd);
+                    watch->fd = -1;
+                } else {
+                    fmw_push_event(events, &events_count, events_capacity, (int) j, watch->path, NULL);
+                }
+            }
+
+            for (size_t j = 0; j < fmw->files_count; ++j) {
+                Fmw_File *file = &fmw->files[j];
+                if (file->fd != fd) continue;
+
+                // NOTE: a replaced file is reported by the rescan of
+                // its directory below, once the new one is there
+                if (gone) {
+                    close(file->fd);
+                    file->fd = -1;
+                    rescan[file->watch] = true;
+                } else {
+                    fmw_push_event(events, &events_count, events_capacity, file->watch, file->path, NULL);
+                }
+            }
+        }
+    }
+
+    for (size_t j = 0; j < fmw->watches_count; ++j) {
+        if (rescan[j]) {
+            fmw_scan_dir(fmw, (int) j, events, &events_count, events_capacity);
+        }
     }
 
-    // check for writes (and deletes?? not sure how to handle deletes though)
-    if (num_events > 0 && event.fflags & (NOTE_DELETE| NOTE_EXTEND | NOTE_WRITE)) {
-        return true;
-    } else {
-        return false;
+    // NOTE: the watched files that were replaced are picked up again
+    // as soon as the new ones show up
+    for (size_t j = 0; j < fmw->watches_count; ++j) {
+        Fmw_Watch *watch = &fmw->watches[j];
+        if (watch->fd != -1 || watch->is_dir) continue;
+
+        watch->fd = fmw_open(fmw, watch->path);
+        if (watch->fd != -1) {
+            fmw_push_event(events, &events_count, events_capacity, (int) j, watch->path, NULL);
+        }
     }
+
+    return events_count;
 }
@@ -18,8 +18,7 @@ SDL_Rect Bitmap_Font::char_rect(char x)
 void Bitmap_Font::render(SDL_Renderer *renderer, Vec2f position, Vec2f size, RGBA color, String_View sv)
 {
     SDL_Color sdl_color = rgba_to_sdl(color);
-    sec(SDL_SetTextureColorMod(bitmap, sdl_color.r, sdl_color.g, sdl_color.b));
-    sec(SDL_SetTextureAlphaMod(bitmap, sdl_color.a));
+    render_texture_mod(bitmap, sdl_color);
 
     for (int row = 0; sv.count > 0; ++row) {
         auto line = sv.chop_by_delim('\n');
@@ -32,7 +31,7 @@ void Bitmap_Font::render(SDL_Renderer *renderer, Vec2f position, Vec2f size, RGB
                 (int) floorf(src_rect.w * size.x),
                 (int) floorf(src_rect.h * size.y)
             };
-            sec(SDL_RenderCopy(renderer, bitmap, &src_rect, &dest_rect));
+            render_copy(renderer, bitmap, &src_rect, &dest_rect);
         }
     }
 }
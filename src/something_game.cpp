@@ -33,7 +33,6 @@ void Projectile::kill()
 {
     if (state == Projectile_State::Active) {
         state = Projectile_State::Poof;
-        assets.animats[poof_animat.unwrap].unwrap.reset();
     }
 }
 
@@ -61,6 +60,14 @@ void Game::handle_event(SDL_Event *event)
             bfs_debug = !bfs_debug;
         } break;
 
+        case SDLK_F4: {
+            profiler_debug = !profiler_debug;
+        } break;
+
+        case SDLK_F7: {
+            memory_debug = !memory_debug;
+        } break;
+
         case SDLK_F5: {
             command_reload(this, ""_sv);
         } break;
@@ -188,56 +195,62 @@ void Game::handle_event(SDL_Event *event)
 
 void Game::update(float dt)
 {
+    PROFILE_ZONE("Game::update");
+    mixer.listener = camera.pos;
+
     // Update Player's gun direction //////////////////////////////
     int mouse_x, mouse_y;
     SDL_GetMouseState(&mouse_x, &mouse_y);
     entities[PLAYER_ENTITY_INDEX].point_gun_at(mouse_position);
 
     // Enemy AI //////////////////////////////
-    auto &player = entities[PLAYER_ENTITY_INDEX];
-    Recti *lock = NULL;
-    for (size_t i = 0; i < camera_locks_count; ++i) {
-        Rectf lock_abs = rect_cast<float>(camera_locks[i]) * TILE_SIZE;
-        if (rect_contains_vec2(lock_abs, player.pos)) {
-            lock = &camera_locks[i];
+    {
+        PROFILE_ZONE("Enemy AI");
+        auto &player = entities[PLAYER_ENTITY_INDEX];
+        Recti *lock = NULL;
+        for (size_t i = 0; i < camera_locks_count; ++i) {
+            Rectf lock_abs = rect_cast<float>(camera_locks[i]) * TILE_SIZE;
+            if (rect_contains_vec2(lock_abs, player.pos)) {
+                lock = &camera_locks[i];
+            }
         }
-    }
 
-    auto player_tile = grid.abs_to_tile_coord(player.pos);
-    if (lock) {
-        grid.bfs_to_tile(player_tile, lock);
-    }
-
-    if (!debug && lock) {
-        Rectf lock_abs = rect_cast<float>(*lock) * TILE_SIZE;
-        for (size_t i = ENEMY_ENTITY_INDEX_OFFSET; i < ENTITIES_COUNT; ++i) {
-            auto &enemy =  entities[i];
-            if (enemy.state == Entity_State::Alive) {
-                if (rect_contains_vec2(lock_abs, enemy.pos)) {
-                    if (grid.a_sees_b(enemy.pos, player.pos)) {
-                        enemy.stop();
-                        enemy.point_gun_at(player.pos);
-                        entity_shoot({i});
-                    } else {
-                        auto enemy_tile = grid.abs_to_tile_coord(enemy.pos);
-                        auto next = grid.next_in_bfs(enemy_tile, lock);
-                        if (next.has_value) {
-                            auto d = next.unwrap - enemy_tile;
+        auto player_tile = grid.abs_to_tile_coord(player.pos);
+        if (lock) {
+            grid.bfs_to_tile(player_tile, lock);
+        }
 
-                            if (d.y < 0) {
-                                enemy.jump();
-                            }
-                            if (d.x > 0) {
-                                enemy.move(Entity::Right);
-                            }
-                            if (d.x < 0) {
-                                enemy.move(Entity::Left);
-                            }
-                            if (d.x == 0) {
+        if (!debug && lock) {
+            Rectf lock_abs = rect_cast<float>(*lock) * TILE_SIZE;
+            for (size_t i = ENEMY_ENTITY_INDEX_OFFSET; i < ENTITIES_COUNT; ++i) {
+                auto &enemy =  entities[i];
+                if (enemy.state == Entity_State::Alive) {
+                    if (rect_contains_vec2(lock_abs, enemy.pos)) {
+                        if (grid.a_sees_b(enemy.pos, player.pos)) {
+                            enemy.stop();
+                            enemy.point_gun_at(player.pos);
+                            entity_shoot({i});
+                        } else {
+                            auto enemy_tile = grid.abs_to_tile_coord(enemy.pos);
+                            auto next = grid.next_in_bfs(enemy_tile, lock);
+                            if (next.has_value) {
+                                auto d = next.unwrap - enemy_tile;
+
+                                if (d.y < 0) {
+                                    enemy.jump();
+                                }
+                                if (d.x > 0) {
+                                    enemy.move(Entity::Right);
+                                }
+                                if (d.x < 0) {
+                                    enemy.move(Entity::Left);
+                                }
+                                if (d.x == 0) {
+                                    enemy.stop();
+                                }
+                            } else {
                                 enemy.stop();
                             }
-                        } else {
-                            enemy.stop();
                         }
                     }
                 }
@@ -246,110 +259,140 @@ void Game::update(float dt)
     }
 
     // Update All Entities //////////////////////////////
-    for (size_t i = 0; i < ENTITIES_COUNT; ++i) {
-        entities[i].update(dt, &mixer, &grid);
-        entity_resolve_collision({i});
-        entities[i].has_jumped = false;
+    {
+        PROFILE_ZONE("Entities");
+        for (size_t i = 0; i < ENTITIES_COUNT; ++i) {
+            entities[i].update(dt, &mixer, &grid, &rngs[RNG_STREAM_PARTICLES], &rngs[RNG_STREAM_SOUNDS]);
+            entity_resolve_collision({i});
+            entities[i].has_jumped = false;
+        }
     }
 
     // Update All Projectiles //////////////////////////////
-    update_projectiles(dt);
+    {
+        PROFILE_ZONE("Projectiles");
+        update_projectiles(dt);
+    }
 
     // Update Items //////////////////////////////
-    for (size_t i = 0; i < ITEMS_COUNT; ++i) {
-        items[i].update(dt);
+    {
+        PROFILE_ZONE("Items");
+        for (size_t i = 0; i < ITEMS_COUNT; ++i) {
+            items[i].update(dt);
+        }
     }
 
     // Entities/Projectiles interaction //////////////////////////////
-    for (size_t index = 0; index < PROJECTILES_COUNT; ++index) {
-        auto projectile = projectiles + index;
-        if (projectile->state != Projectile_State::Active) continue;
-
-        for (size_t entity_index = 0;
-             entity_index < ENTITIES_COUNT;
-             ++entity_index)
-        {
-            auto entity = entities + entity_index;
-
-            if (entity->state != Entity_State::Alive) continue;
-            if (entity_index == projectile->shooter.unwrap) continue;
-
-            if (rect_contains_vec2(entity->hitbox_world(), projectile->pos)) {
-                projectile->kill();
-                entity->lives -= ENTITY_PROJECTILE_DAMAGE;
-
-                mixer.play_sample(assets.sounds[assets.get_sound_by_id_or_panic("OOF_SOUND"_sv).unwrap].unwrap);
-                if (entity->lives <= 0) {
-                    for (size_t i = 0; i < entity->dirt_blocks_count; ++i) {
-                        const float ITEMS_DROP_PROXIMITY = 50.0f;
-                        auto random_vector = polar(
-                            ITEMS_DROP_PROXIMITY,
-                            rand_float_range(0, 2.0f * PI));
-                        spawn_dirt_block_item_at(entity->pos + random_vector);
-                    }
-
-                    for (size_t i = 0; i < entity->ice_blocks_count; ++i) {
-                        const float ITEMS_DROP_PROXIMITY = 50.0f;
-                        auto random_vector = polar(
-                            ITEMS_DROP_PROXIMITY,
-                            rand_float_range(0, 2.0f * PI));
-                        spawn_item_at(make_ice_block_item(vec2(0.0f, 0.0f)),
-                                      entity->pos + random_vector);
-                    }
-
-                    entity->kill();
-                    mixer.play_sample(assets.sounds[assets.get_sound_by_id_or_panic("CRUNCH_SOUND"_sv).unwrap].unwrap);
-                } else {
-                    entity->vel += normalize(projectile->vel) * ENTITY_PROJECTILE_KNOCKBACK;
-                    entity->flash(ENTITY_DAMAGE_FLASH_COLOR);
-                }
-            }
-        }
-    }
+    {
+        PROFILE_ZONE("Interactions");
+        for (size_t index = 0; index < PROJECTILES_COUNT; ++index) {
+            auto projectile = projectiles + index;
+            if (projectile->state != Projectile_State::Active) continue;
 
-    // Entities/Items interaction
-    for (size_t index = 0; index < ITEMS_COUNT; ++index) {
-        auto item = items + index;
-        if (item->type != ITEM_NONE) {
             for (size_t entity_index = 0;
                  entity_index < ENTITIES_COUNT;
                  ++entity_index)
             {
                 auto entity = entities + entity_index;
 
-                if (entity->state == Entity_State::Alive) {
-                    if (rects_overlap(entity->hitbox_world(), item->hitbox_world())) {
-                        switch (item->type) {
-                        case ITEM_NONE: {
-                            assert(0 && "unreachable");
-                        } break;
-
-                        case ITEM_HEALTH: {
-                            entity->lives = min(entity->lives + ITEM_HEALTH_POINTS, ENTITY_MAX_LIVES);
-                            entity->flash(ENTITY_HEAL_FLASH_COLOR);
-                            mixer.play_sample(assets.sounds[item->sound.unwrap].unwrap);
-                            item->type = ITEM_NONE;
-                        } break;
-
-                        case ITEM_DIRT_BLOCK: {
-                            entity->dirt_blocks_count += 1;
-                            mixer.play_sample(assets.sounds[item->sound.unwrap].unwrap);
-                            item->type = ITEM_NONE;
-                        } break;
-
-                        case ITEM_ICE_BLOCK: {
-                            entity->ice_blocks_count += 1;
-                            mixer.play_sample(assets.sounds[item->sound.unwrap].unwrap);
-                            item->type = ITEM_NONE;
-                        } break;
+                if (entity->state != Entity_State::Alive) continue;
+                if (entity_index == projectile->shooter.unwrap) continue;
+
+                if (rect_contains_vec2(entity->hitbox_world(), projectile->pos)) {
+                    projectile->kill();
+                    entity->lives -= ENTITY_PROJECTILE_DAMAGE;
+
+                    mixer.play_sample_at(
+                        assets.sounds[assets.handles.oof_sound.unwrap].unwrap,
+                        {SOUND_HURT_PRIORITY, SOUND_HURT_MAX_INSTANCES, 1.0f},
+                        entity->pos);
+                    if (entity->lives <= 0) {
+                        for (size_t i = 0; i < entity->dirt_blocks_count; ++i) {
+                            const float ITEMS_DROP_PROXIMITY = 50.0f;
+                            auto random_vector = polar(
+                                ITEMS_DROP_PROXIMITY,
+                                rngs[RNG_STREAM_DROPS].range(0, 2.0f * PI));
+                            spawn_dirt_block_item_at(entity->pos + random_vector);
+                        }
+
+                        for (size_t i = 0; i < entity->ice_blocks_count; ++i) {
+                            const float ITEMS_DROP_PROXIMITY = 50.0f;
+                            auto random_vector = polar(
+                                ITEMS_DROP_PROXIMITY,
+                                rngs[RNG_STREAM_DROPS].range(0, 2.0f * PI));
+                            spawn_item_at(make_ice_block_item(vec2(0.0f, 0.0f)),
+                                          entity->pos + random_vector);
+                        }
+
+                        entity->kill();
+                        mixer.play_sample_at(
+                            assets.sounds[assets.handles.crunch_sound.unwrap].unwrap,
+                            {SOUND_DEATH_PRIORITY, SOUND_DEATH_MAX_INSTANCES, 1.0f},
+                            entity->pos);
+                    } else {
+                        entity->vel += normalize(projectile->vel) * ENTITY_PROJECTILE_KNOCKBACK;
+                        entity->flash(ENTITY_DAMAGE_FLASH_COLOR);
+                    }
+                }
+            }
+        }
+
+        // Entities/Items interaction
+        for (size_t index = 0; index < ITEMS_COUNT; ++index) {
+            auto item = items + index;
+            if (item->type != ITEM_NONE) {
+                for (size_t entity_index = 0;
+                     entity_index < ENTITIES_COUNT;
+                     ++entity_index)
+                {
+                    auto entity = entities + entity_index;
+
+                    if (entity->state == Entity_State::Alive) {
+                        if (rects_overlap(entity->hitbox_world(), item->hitbox_world())) {
+                            switch (item->type) {
+                            case ITEM_NONE: {
+                                assert(0 && "unreachable");
+                            } break;
+
+                            case ITEM_HEALTH: {
+                                entity->lives = min(entity->lives + ITEM_HEALTH_POINTS, ENTITY_MAX_LIVES);
+                                entity->flash(ENTITY_HEAL_FLASH_COLOR);
+                                mixer.play_sample_at(
+                                    assets.sounds[item->sound.unwrap].unwrap,
+                                    {SOUND_ITEM_PRIORITY, SOUND_ITEM_MAX_INSTANCES, 1.0f},
+                                    entity->pos);
+                                item->type = ITEM_NONE;
+                            } break;
+
+                            case ITEM_DIRT_BLOCK: {
+                                entity->dirt_blocks_count += 1;
+                                mixer.play_sample_at(
+                                    assets.sounds[item->sound.unwrap].unwrap,
+                                    {SOUND_ITEM_PRIORITY, SOUND_ITEM_MAX_INSTANCES, 1.0f},
+                                    entity->pos);
+                                item->type = ITEM_NONE;
+                            } break;
+
+                            case ITEM_ICE_BLOCK: {
+                                entity->ice_blocks_count += 1;
+                                mixer.play_sample_at(
+                                    assets.sounds[item->sound.unwrap].unwrap,
+                                    {SOUND_ITEM_PRIORITY, SOUND_ITEM_MAX_INSTANCES, 1.0f},
+                                    entity->pos);
+                                item->type = ITEM_NONE;
+                            } break;
+                            }
+                            break;
                         }
-                        break;
                     }
                 }
             }
         }
     }
 
+    // Animations //////////////////////////////
+    update_animat_playbacks(dt);
+
     // Player Movement //////////////////////////////
     if (!console.enabled) {
         if (keyboard[SDL_SCANCODE_D]) {
@@ -383,6 +426,7 @@ void Game::update(float dt)
 
 void Game::render(SDL_Renderer *renderer)
 {
+    PROFILE_ZONE("Game::render");
     Recti *lock = NULL;
     for (size_t i = 0; i < camera_locks_count; ++i) {
         Rectf lock_abs = rect_cast<float>(camera_locks[i]) * TILE_SIZE;
@@ -391,20 +435,42 @@ void Game::render(SDL_Renderer *renderer)
         }
     }
 
-    background.render(renderer, camera);
+    {
+        PROFILE_ZONE("Background");
+        background.render(renderer, camera);
+    }
 
-    if (bfs_debug && lock) {
-        grid.render_debug_bfs_overlay(
-            renderer,
-            &camera,
-            lock);
+    {
+        PROFILE_ZONE("Tiles");
+        if (bfs_debug && lock) {
+            grid.render_debug_bfs_overlay(
+                renderer,
+                &camera,
+                lock);
+        }
+
+        grid.render(renderer, camera, lock);
     }
 
-    grid.render(renderer, camera, lock);
+    {
+        PROFILE_ZONE("Entities");
+        // NOTE: the flashes of all of the entities are mixed into their
+        // shades and converted for SDL in one pass
+        RGBA shades[ENTITIES_COUNT];
+        RGBA flashes[ENTITIES_COUNT];
+        RGBA mixed[ENTITIES_COUNT];
+        SDL_Color sdl_shades[ENTITIES_COUNT];
+        for (size_t i = 0; i < ENTITIES_COUNT; ++i) {
+            shades[i] = {0, 0, 0, 0};
+            flashes[i] = entities[i].effective_flash_color();
+        }
+        mix_colors_batch(shades, flashes, mixed, ENTITIES_COUNT);
+        rgba_to_sdl_batch(mixed, sdl_shades, ENTITIES_COUNT);
 
-    for (size_t i = 0; i < ENTITIES_COUNT; ++i) {
-        // TODO(#106): display health bar differently for enemies in a different room
-        entities[i].render(renderer, camera);
+        for (size_t i = 0; i < ENTITIES_COUNT; ++i) {
+            // TODO(#106): display health bar differently for enemies in a different room
+            entities[i].render(renderer, camera, *entity_playback({i}), sdl_shades[i]);
+        }
     }
 
     switch (entities[PLAYER_ENTITY_INDEX].current_weapon) {
@@ -439,22 +505,41 @@ void Game::render(SDL_Renderer *renderer)
     } break;
     }
 
-    render_projectiles(renderer, camera);
+    {
+        PROFILE_ZONE("Projectiles");
+        render_projectiles(renderer, camera);
+    }
 
-    for (size_t i = 0; i < ITEMS_COUNT; ++i) {
-        if (items[i].type != ITEM_NONE) {
-            items[i].render(renderer, camera);
+    {
+        PROFILE_ZONE("Items");
+        for (size_t i = 0; i < ITEMS_COUNT; ++i) {
+            if (items[i].type != ITEM_NONE) {
+                items[i].render(renderer, camera);
+            }
         }
     }
 
-    if (fps_debug) {
-        render_fps_overlay(renderer);
-    }
+    {
+        PROFILE_ZONE("HUD");
+        Render_Subsystem_Scope scope(RENDER_SUBSYSTEM_UI);
 
-    render_player_hud(renderer);
+        if (fps_debug) {
+            render_fps_overlay(renderer);
+        }
 
-    popup.render(renderer);
-    console.render(renderer, &debug_font);
+        if (profiler_debug) {
+            render_profiler_overlay(renderer);
+        }
+
+        if (memory_debug) {
+            render_memory_overlay(renderer);
+        }
+
+        render_player_hud(renderer);
+
+        popup.render(renderer);
+        console.render(renderer, &debug_font);
+    }
 }
 
 void Game::entity_shoot(Entity_Index entity_index)
@@ -472,7 +557,10 @@ void Game::entity_shoot(Entity_Index entity_index)
                     entity_index);
                 entity->cooldown_weapon = ENTITY_COOLDOWN_WEAPON;
 
-                mixer.play_sample(assets.sounds[entity->shoot_sample.unwrap].unwrap);
+                mixer.play_sample_at(
+                    assets.sounds[entity->shoot_sample.unwrap].unwrap,
+                    {SOUND_SHOOT_PRIORITY, SOUND_SHOOT_MAX_INSTANCES, 1.0f},
+                    entity->pos);
             }
         } break;
 
@@ -567,9 +655,7 @@ void Game::entity_resolve_collision(Entity_Index entity_index)
                 const int IMPACT_THRESHOLD = 5;
                 if (abs(d.y) >= IMPACT_THRESHOLD && !entity->has_jumped) {
                     if (fabsf(entity->vel.y) > LANDING_PARTICLE_BURST_THRESHOLD) {
-                        for (int i = 0; i < ENTITY_JUMP_PARTICLE_BURST; ++i) {
-                            entity->particles.push(rand_float_range(PARTICLE_JUMP_VEL_LOW, fabsf(entity->vel.y) * 0.25f));
-                        }
+                        entity->particles.push_burst(ENTITY_JUMP_PARTICLE_BURST, PARTICLE_JUMP_VEL_LOW, fabsf(entity->vel.y) * 0.25f, &rngs[RNG_STREAM_PARTICLES]);
                     }
 
                     entity->vel.y = 0;
@@ -591,8 +677,8 @@ void Game::spawn_projectile(Vec2f pos, Vec2f vel, Entity_Index shooter)
             projectiles[i].vel = vel;
             projectiles[i].shooter = shooter;
             projectiles[i].lifetime = PROJECTILE_LIFETIME;
-            projectiles[i].active_animat = assets.get_animat_by_id_or_panic("PROJECTILE_IDLE_ANIMAT"_sv);
-            projectiles[i].poof_animat = assets.get_animat_by_id_or_panic("PROJECTILE_POOF_ANIMAT"_sv);
+            projectiles[i].active_animat = assets.handles.projectile_idle_animat;
+            projectiles[i].poof_animat = assets.handles.projectile_poof_animat;
             return;
         }
     }
@@ -600,7 +686,9 @@ void Game::spawn_projectile(Vec2f pos, Vec2f vel, Entity_Index shooter)
 
 void Game::render_debug_overlay(SDL_Renderer *renderer, size_t fps)
 {
-    sec(SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255));
+    Render_Subsystem_Scope scope(RENDER_SUBSYSTEM_UI);
+
+    render_draw_color(renderer, {255, 0, 0, 255});
 
     const float COLLISION_PROBE_SIZE = 10.0f;
     const auto collision_probe_rect = rect(
@@ -608,7 +696,7 @@ void Game::render_debug_overlay(SDL_Renderer *renderer, size_t fps)
         COLLISION_PROBE_SIZE * 2, COLLISION_PROBE_SIZE * 2);
     {
         auto rect = rectf_for_sdl(collision_probe_rect);
-        sec(SDL_RenderFillRect(renderer, &rect));
+        render_fill_rect(renderer, &rect);
     }
 
     const float PADDING = 10.0f;
@@ -652,6 +740,36 @@ void Game::render_debug_overlay(SDL_Renderer *renderer, size_t fps)
              "Player velocity: ",
              entities[PLAYER_ENTITY_INDEX].vel.x, " ",
              entities[PLAYER_ENTITY_INDEX].vel.y);
+    displayf(renderer, &debug_font,
+             FONT_DEBUG_COLOR,
+             FONT_SHADOW_COLOR,
+             vec2(PADDING, 6 * 50 + PADDING),
+             "Audio: ",
+             SDL_AtomicGet(&mixer.stats.duration_us), "/",
+             SDL_AtomicGet(&mixer.stats.period_us), " us, voices: ",
+             SDL_AtomicGet(&mixer.stats.active_voices), "/",
+             SAMPLE_MIXER_CAPACITY);
+    displayf(renderer, &debug_font,
+             FONT_DEBUG_COLOR,
+             FONT_SHADOW_COLOR,
+             vec2(PADDING, 7 * 50 + PADDING),
+             "Audio dropped: ", SDL_AtomicGet(&mixer.stats.dropped),
+             ", late: ", SDL_AtomicGet(&mixer.stats.late),
+             ", underruns: ", SDL_AtomicGet(&mixer.music.underruns));
+
+    // NOTE: the counters of the previous frame, this one is not over yet
+    for (size_t i = 0; i <= RENDER_SUBSYSTEMS_COUNT; ++i) {
+        const Render_Counters counters =
+            i < RENDER_SUBSYSTEMS_COUNT ? render_stats.last[i] : render_stats.last_total();
+        displayf(renderer, &debug_font,
+                 FONT_DEBUG_COLOR,
+                 FONT_SHADOW_COLOR,
+                 vec2(PADDING, (float) (8 + i) * 50 + PADDING),
+                 i < RENDER_SUBSYSTEMS_COUNT ? render_subsystem_names[i] : "total",
+                 ": draws ", counters.draw_calls,
+                 ", states ", counters.state_changes,
+                 ", quads ", counters.quads);
+    }
 
     if (tracking_projectile.has_value) {
         auto projectile = projectiles[tracking_projectile.unwrap.unwrap];
@@ -685,32 +803,32 @@ void Game::render_debug_overlay(SDL_Renderer *renderer, size_t fps)
     for (size_t i = 0; i < ENTITIES_COUNT; ++i) {
         if (entities[i].state == Entity_State::Ded) continue;
 
-        sec(SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255));
+        render_draw_color(renderer, {255, 0, 0, 255});
         auto dstrect = rectf_for_sdl(camera.to_screen(entities[i].texbox_world()));
-        sec(SDL_RenderDrawRect(renderer, &dstrect));
+        render_draw_rect(renderer, &dstrect);
 
-        sec(SDL_SetRenderDrawColor(renderer, 255, 255, 0, 255));
+        render_draw_color(renderer, {255, 255, 0, 255});
         auto hitbox = rectf_for_sdl(camera.to_screen(entities[i].hitbox_world()));
-        sec(SDL_RenderDrawRect(renderer, &hitbox));
+        render_draw_rect(renderer, &hitbox);
 
         entities[i].render_debug(renderer, camera);
     }
 
     if (tracking_projectile.has_value) {
-        sec(SDL_SetRenderDrawColor(renderer, 255, 255, 0, 255));
+        render_draw_color(renderer, {255, 255, 0, 255});
         auto hitbox = rectf_for_sdl(
             camera.to_screen(hitbox_of_projectile(tracking_projectile.unwrap)));
-        sec(SDL_RenderDrawRect(renderer, &hitbox));
+        render_draw_rect(renderer, &hitbox);
     }
 
     auto projectile_index = projectile_at_position(mouse_position);
     if (projectile_index.has_value) {
-        sec(SDL_SetRenderDrawColor(renderer, 255, 255, 0, 255));
+        render_draw_color(renderer, {255, 255, 0, 255});
         auto hitbox = rectf_for_sdl(
             camera.to_screen(hitbox_of_projectile(projectile_index.unwrap)));
-        sec(SDL_RenderDrawRect(renderer, &hitbox));
+        render_draw_rect(renderer, &hitbox);
     } else {
-        sec(SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255));
+        render_draw_color(renderer, {255, 0, 0, 255});
         const Rectf tile_rect = {
             floorf(mouse_position.x / TILE_SIZE) * TILE_SIZE,
             floorf(mouse_position.y / TILE_SIZE) * TILE_SIZE,
@@ -719,7 +837,7 @@ void Game::render_debug_overlay(SDL_Renderer *renderer, size_t fps)
         };
 
         auto rect = rectf_for_sdl(camera.to_screen(tile_rect));
-        sec(SDL_RenderDrawRect(renderer, &rect));
+        render_draw_rect(renderer, &rect);
     }
 
     for (size_t i = 0; i < ITEMS_COUNT; ++i) {
@@ -748,6 +866,79 @@ void Game::render_fps_overlay(SDL_Renderer *renderer) {
     }
 }
 
+void Game::render_profiler_overlay(SDL_Renderer *renderer)
+{
+    const size_t PROFILER_OVERLAY_EVENTS_CAPACITY = 1024;
+    const float PADDING = 20.0f;
+    const float ROW_HEIGHT = 20.0f;
+    const float LABEL_SIZE = 2.0f;
+    const uint32_t ROWS = 8;
+
+    // NOTE: the last frame of the thread that renders, which is the
+    // main one
+    Profiler_Thread *thread = profile_current_thread();
+    if (thread == NULL) return;
+
+    static Profile_Event events[PROFILER_OVERLAY_EVENTS_CAPACITY];
+    const size_t events_size = profile_last_root(thread, events, PROFILER_OVERLAY_EVENTS_CAPACITY);
+    if (events_size == 0) return;
+
+    const Profile_Event root = events[0];
+    const float width = SCREEN_WIDTH - 2.0f * PADDING;
+    const float duration = (float) (root.end - root.begin);
+    const float top = SCREEN_HEIGHT - PADDING - (float) ROWS * ROW_HEIGHT;
+    const auto label_size = vec2(LABEL_SIZE, LABEL_SIZE);
+
+    for (size_t i = 0; i < events_size; ++i) {
+        const Profile_Event *event = &events[i];
+        if (event->depth >= ROWS) continue;
+
+        const float x = PADDING + (float) (event->begin - root.begin) / duration * width;
+        const float w = max((float) (event->end - event->begin) / duration * width, 1.0f);
+        const float y = top + (float) event->depth * ROW_HEIGHT;
+
+        // NOTE: the same zone gets the same color in every frame
+        const uint32_t hue = (uint32_t) ((uintptr_t) event->name * 2654435761u) >> 8;
+        const HSLA color = {(float) (hue % 360), 0.6f, 0.5f, 0.8f};
+        fill_rect(renderer, rect(vec2(x, y), w, ROW_HEIGHT - 1.0f), color.to_rgba());
+
+        const auto size = debug_font.text_size(label_size, event->name);
+        if (size.x + 4.0f <= w) {
+            debug_font.render(renderer, vec2(x + 2.0f, y + 1.0f), label_size, FONT_DEBUG_COLOR, event->name);
+        }
+    }
+
+    char text[256];
+    snprintf(text, sizeof(text), "%s: %.2f ms",
+             root.name, (double) duration * 1000.0 / (double) SDL_GetPerformanceFrequency());
+    debug_font.render(renderer, vec2(PADDING, top - ROW_HEIGHT), label_size, FONT_DEBUG_COLOR, text);
+}
+
+void Game::render_memory_overlay(SDL_Renderer *renderer)
+{
+    const float PADDING = 20.0f;
+    const float ROW_HEIGHT = 20.0f;
+    const float LABEL_SIZE = 2.0f;
+    const auto label_size = vec2(LABEL_SIZE, LABEL_SIZE);
+
+    char rows[MEMORY_SUBSYSTEMS_COUNT + 2][128];
+    memory_stats.format_header(rows[0], sizeof(rows[0]));
+    for (size_t i = 0; i <= MEMORY_SUBSYSTEMS_COUNT; ++i) {
+        memory_stats.format_row(i, rows[i + 1], sizeof(rows[i + 1]));
+    }
+    const size_t rows_count = sizeof(rows) / sizeof(rows[0]);
+
+    const float width = debug_font.text_size(label_size, rows[0]).x;
+    const Vec2f position = vec2(SCREEN_WIDTH - PADDING - width, PADDING);
+    fill_rect(renderer,
+              rect(position - vec2(4.0f, 4.0f), width + 8.0f, (float) rows_count * ROW_HEIGHT + 8.0f),
+              CONSOLE_BACKGROUND_COLOR);
+    for (size_t i = 0; i < rows_count; ++i) {
+        debug_font.render(renderer, position + vec2(0.0f, (float) i * ROW_HEIGHT),
+                          label_size, FONT_DEBUG_COLOR, rows[i]);
+    }
+}
+
 int Game::count_alive_projectiles(void)
 {
     int res = 0;
@@ -759,16 +950,13 @@ int Game::count_alive_projectiles(void)
 
 void Game::render_projectiles(SDL_Renderer *renderer, Camera camera)
 {
+    Render_Subsystem_Scope scope(RENDER_SUBSYSTEM_ENTITIES);
+
     for (size_t i = 0; i < PROJECTILES_COUNT; ++i) {
         switch (projectiles[i].state) {
-        case Projectile_State::Active: {
-            assets.animats[projectiles[i].active_animat.unwrap].unwrap.render(
-                renderer,
-                camera.to_screen(projectiles[i].pos));
-        } break;
-
+        case Projectile_State::Active:
         case Projectile_State::Poof: {
-            assets.animats[projectiles[i].poof_animat.unwrap].unwrap.render(
+            projectile_playback({i})->render(
                 renderer,
                 camera.to_screen(projectiles[i].pos));
         } break;
@@ -783,17 +971,17 @@ void Game::update_projectiles(float dt)
     for (size_t i = 0; i < PROJECTILES_COUNT; ++i) {
         switch (projectiles[i].state) {
         case Projectile_State::Active: {
-            assets.animats[projectiles[i].active_animat.unwrap].unwrap.update(dt);
             projectiles[i].pos += projectiles[i].vel * dt;
 
-            auto tile = grid.tile_at_abs(projectiles[i].pos);
-            if (tile && tile_defs[*tile].is_collidable) {
+            const auto coord = grid.abs_to_tile_coord(projectiles[i].pos);
+            const auto tile = grid.get_tile(coord);
+            if (tile_defs[tile].is_collidable) {
                 projectiles[i].kill();
-                if ((TILE_DIRT_0 <= *tile && *tile < TILE_DIRT_3) ||
-                    (TILE_ICE_0 <= *tile && *tile < TILE_ICE_3)) {
-                    *tile += 1;
-                } else if (*tile == TILE_DIRT_3 || *tile == TILE_ICE_3) {
-                    *tile = TILE_EMPTY;
+                if ((TILE_DIRT_0 <= tile && tile < TILE_DIRT_3) ||
+                    (TILE_ICE_0 <= tile && tile < TILE_ICE_3)) {
+                    grid.set_tile(coord, tile + 1);
+                } else if (tile == TILE_DIRT_3 || tile == TILE_ICE_3) {
+                    grid.set_tile(coord, TILE_EMPTY);
                 }
             }
 
@@ -805,9 +993,7 @@ void Game::update_projectiles(float dt)
         } break;
 
         case Projectile_State::Poof: {
-            assets.animats[projectiles[i].poof_animat.unwrap].unwrap.update(dt);
-            if (assets.animats[projectiles[i].poof_animat.unwrap].unwrap.frame_current ==
-                (assets.animats[projectiles[i].poof_animat.unwrap].unwrap.frame_count - 1)) {
+            if (projectile_playback({i})->finished()) {
                 projectiles[i].state = Projectile_State::Ded;
             }
         } break;
@@ -817,6 +1003,44 @@ void Game::update_projectiles(float dt)
     }
 }
 
+Frame_Animat_Playback *Game::entity_playback(Entity_Index index)
+{
+    assert(index.unwrap < ENTITIES_COUNT);
+    return &animat_playbacks[index.unwrap];
+}
+
+Frame_Animat_Playback *Game::projectile_playback(Projectile_Index index)
+{
+    assert(index.unwrap < PROJECTILES_COUNT);
+    return &animat_playbacks[ENTITIES_COUNT + index.unwrap];
+}
+
+void Game::update_animat_playbacks(float dt)
+{
+    for (size_t i = 0; i < ENTITIES_COUNT; ++i) {
+        entities[i].update_animat_playback(entity_playback({i}));
+    }
+
+    for (size_t i = 0; i < PROJECTILES_COUNT; ++i) {
+        auto playback = projectile_playback({i});
+        switch (projectiles[i].state) {
+        case Projectile_State::Active: {
+            playback->play(projectiles[i].active_animat);
+        } break;
+
+        case Projectile_State::Poof: {
+            playback->play(projectiles[i].poof_animat);
+        } break;
+
+        case Projectile_State::Ded: {
+            playback->paused = true;
+        } break;
+        }
+    }
+
+    update_frame_animat_playbacks(animat_playbacks, ANIMAT_PLAYBACKS_COUNT, dt);
+}
+
 const float PROJECTILE_TRACKING_PADDING = 50.0f;
 
 Rectf Game::hitbox_of_projectile(Projectile_Index index)
@@ -880,12 +1104,31 @@ void Game::spawn_health_at_mouse()
     }
 }
 
+void Game::seed_rngs(uint64_t seed)
+{
+    for (size_t i = 0; i < RNG_STREAMS_COUNT; ++i) {
+        rngs[i] = make_rng(seed, i);
+    }
+}
+
 void Game::add_camera_lock(Recti rect)
 {
     assert(camera_locks_count < CAMERA_LOCKS_CAPACITY);
     camera_locks[camera_locks_count++] = rect;
 }
 
+void Game::remove_camera_lock(Recti rect)
+{
+    for (size_t i = 0; i < camera_locks_count; ++i) {
+        if (camera_locks[i].x == rect.x && camera_locks[i].y == rect.y &&
+            camera_locks[i].w == rect.w && camera_locks[i].h == rect.h)
+        {
+            camera_locks[i] = camera_locks[--camera_locks_count];
+            return;
+        }
+    }
+}
+
 void Game::spawn_entity_at(Entity entity, Vec2f pos)
 {
     entity.pos = pos;
@@ -951,7 +1194,7 @@ void Game::render_player_hud(SDL_Renderer *renderer)
 
     snprintf(stats[WEAPON_GUN].label, sizeof(stats[WEAPON_GUN].label), "inf");
     {
-        auto animat = assets.animats[assets.get_animat_by_id_or_panic("PROJECTILE_IDLE_ANIMAT"_sv).unwrap].unwrap;
+        auto animat = assets.animats[assets.handles.projectile_idle_animat.unwrap].unwrap;
         assert(animat.frame_count > 0);
         stats[WEAPON_GUN].icon = animat.frames[0];
     }
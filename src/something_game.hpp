@@ -3,6 +3,7 @@
 
 #include "something_console.hpp"
 #include "something_particles.hpp"
+#include "something_memory.hpp"
 #include "something_texture.hpp"
 #include "something_background.hpp"
 
@@ -40,12 +41,26 @@ struct Projectile
     void kill();
 };
 
+// NOTE: every system that needs random numbers has its own stream, so
+// adding a random call to one of them does not change what the others
+// get
+enum Rng_Stream
+{
+    RNG_STREAM_PARTICLES = 0,
+    RNG_STREAM_SOUNDS,
+    RNG_STREAM_DROPS,
+    RNG_STREAMS_COUNT
+};
+
 const size_t ENEMY_ENTITY_INDEX_OFFSET = 1;
 const size_t PLAYER_ENTITY_INDEX = 0;
 
 const size_t ENTITIES_COUNT = 69;
 const size_t PROJECTILES_COUNT = 69;
 const size_t ITEMS_COUNT = 69;
+// NOTE: entity i plays its animations in animat_playbacks[i],
+// projectile i plays them in animat_playbacks[ENTITIES_COUNT + i]
+const size_t ANIMAT_PLAYBACKS_COUNT = ENTITIES_COUNT + PROJECTILES_COUNT;
 const size_t CAMERA_LOCKS_CAPACITY = 200;
 const size_t ROOM_ROW_COUNT = 8;
 const size_t FPS_BARS_COUNT = 256;
@@ -57,6 +72,8 @@ struct Game
     bool step_debug;
     bool bfs_debug;
     bool fps_debug;
+    bool profiler_debug;
+    bool memory_debug;
     bool holding_down_mouse;
     float frame_delays[FPS_BARS_COUNT];
     size_t frame_delays_begin;
@@ -80,6 +97,8 @@ struct Game
     Entity entities[ENTITIES_COUNT];
     Projectile projectiles[PROJECTILES_COUNT];
 
+    Frame_Animat_Playback animat_playbacks[ANIMAT_PLAYBACKS_COUNT];
+
     Item items[ITEMS_COUNT];
 
     Tile_Grid grid;
@@ -89,7 +108,11 @@ struct Game
 
     Background background;
 
+    Rng rngs[RNG_STREAMS_COUNT];
+
+    void seed_rngs(uint64_t seed);
     void add_camera_lock(Recti rect);
+    void remove_camera_lock(Recti rect);
 
     // Whole Game State
     void update(float dt);
@@ -97,6 +120,13 @@ struct Game
     void handle_event(SDL_Event *event);
     void render_debug_overlay(SDL_Renderer *renderer, size_t fps);
     void render_fps_overlay(SDL_Renderer *renderer);
+    void render_profiler_overlay(SDL_Renderer *renderer);
+    void render_memory_overlay(SDL_Renderer *renderer);
+
+    // Animations of the Game
+    Frame_Animat_Playback *entity_playback(Entity_Index index);
+    Frame_Animat_Playback *projectile_playback(Projectile_Index index);
+    void update_animat_playbacks(float dt);
 
     // Entities of the Game
     void reset_entities();
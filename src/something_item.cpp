@@ -7,6 +7,8 @@ void Item::update(float delta_time)
 
 void Item::render(SDL_Renderer *renderer, Camera camera, RGBA shade) const
 {
+    Render_Subsystem_Scope scope(RENDER_SUBSYSTEM_ENTITIES);
+
     if (type != ITEM_NONE) {
         sprite.render(
             renderer,
@@ -20,14 +22,8 @@ void Item::render_debug(SDL_Renderer *renderer, Camera camera) const
 {
     if (type != ITEM_NONE) {
         auto rect = rectf_for_sdl(camera.to_screen(hitbox_world()));
-        const SDL_Color item_debug_hitbox_color = rgba_to_sdl(ITEM_DEBUG_HITBOX_COLOR);
-        sec(SDL_SetRenderDrawColor(
-                renderer,
-                item_debug_hitbox_color.r,
-                item_debug_hitbox_color.g,
-                item_debug_hitbox_color.b,
-                item_debug_hitbox_color.a));
-        sec(SDL_RenderDrawRect(renderer, &rect));
+        render_draw_color(renderer, rgba_to_sdl(ITEM_DEBUG_HITBOX_COLOR));
+        render_draw_rect(renderer, &rect);
     }
 }
 
@@ -46,7 +42,7 @@ Item make_health_item(Vec2f pos)
     Item item = {};
     item.pos = pos;
     item.type = ITEM_HEALTH;
-    item.sprite.texture_index = assets.get_texture_by_id_or_panic("HEALTH_ITEM_TEXTURE"_sv);
+    item.sprite.texture_index = assets.handles.health_item_texture;
     item.sprite.srcrect = {0, 0, 64, 64};
     item.hitbox_local = {
         ITEM_HITBOX_WIDTH * -0.5f,
@@ -60,7 +56,7 @@ Item make_health_item(Vec2f pos)
         ITEM_TEXBOX_WIDTH,
         ITEM_TEXBOX_HEIGHT
     };
-    item.sound = assets.get_sound_by_id_or_panic("POP_SOUND"_sv);
+    item.sound = assets.handles.pop_sound;
 
     return item;
 }
@@ -83,7 +79,7 @@ Item make_dirt_block_item(Vec2f pos)
         ITEM_TEXBOX_WIDTH,
         ITEM_TEXBOX_HEIGHT
     };
-    item.sound = assets.get_sound_by_id_or_panic("POP_SOUND"_sv);
+    item.sound = assets.handles.pop_sound;
     return item;
 }
 
@@ -105,6 +101,6 @@ Item make_ice_block_item(Vec2f pos)
         ITEM_TEXBOX_WIDTH,
         ITEM_TEXBOX_HEIGHT
     };
-    item.sound = assets.get_sound_by_id_or_panic("POP_SOUND"_sv);
+    item.sound = assets.handles.pop_sound;
     return item;
 }
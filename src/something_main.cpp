@@ -5,7 +5,19 @@ const int SIMULATION_FPS = 60;
 const float SIMULATION_DELTA_TIME = 1.0f / SIMULATION_FPS;
 
 Game game = {};
+World_Streamer world_streamer = {};
+Game_Snapshot quicksave = {};
+Input_Recorder input_recorder = {};
+Input_Replayer input_replayer = {};
+State_Hash_Log state_hash_log = {};
 
+static int compare_room_files(const void *a, const void *b)
+{
+    return strcmp(((const Dynamic_Array<char>*) a)->data, ((const Dynamic_Array<char>*) b)->data);
+}
+
+// NOTE: sorted by name, because the order of readdir differs between
+// the file systems and the rooms of the world are picked by index
 Dynamic_Array<Dynamic_Array<char>> load_room_files_from_dir(const char *room_dir_path)
 {
     Dynamic_Array<Dynamic_Array<char>> room_files = {};
@@ -22,6 +34,9 @@ Dynamic_Array<Dynamic_Array<char>> load_room_files_from_dir(const char *room_dir
          d = readdir(rooms_dir))
     {
         if (*d->d_name == '.') continue;
+        // NOTE: left over by a save_world_file that did not finish
+        const size_t name_len = strlen(d->d_name);
+        if (name_len >= 4 && strcmp(d->d_name + name_len - 4, ".tmp") == 0) continue;
         Dynamic_Array<char> room_file = {};
         room_file.concat(room_dir_path, strlen(room_dir_path));
         room_file.concat(d->d_name, strlen(d->d_name));
@@ -29,26 +44,176 @@ Dynamic_Array<Dynamic_Array<char>> load_room_files_from_dir(const char *room_dir
         room_files.push(room_file);
     }
 
+    if (room_files.size > 0) {
+        qsort(room_files.data, room_files.size, sizeof(room_files.data[0]), compare_room_files);
+    }
+
     return room_files;
 }
 
+// NOTE: FNV-1a over the names of the room files in the order the world
+// streamer indexes them
+uint32_t hash_room_files(Dynamic_Array<Dynamic_Array<char>> room_files)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < room_files.size; ++i) {
+        for (const char *c = room_files.data[i].data; *c != '\0'; ++c) {
+            hash ^= (uint8_t) *c;
+            hash *= 16777619u;
+        }
+        hash ^= (uint8_t) '\n';
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// NOTE: the only place the simulation ticks, so the recorded and the
+// replayed sessions tick the same way
+void simulate_tick()
+{
+    PROFILE_ZONE("Tick");
+    input_recorder.record_tick(game.keyboard);
+    world_streamer.update(&game, game.entities[PLAYER_ENTITY_INDEX].pos);
+    game.update(SIMULATION_DELTA_TIME);
+    state_hash_log.update(&game, &world_streamer);
+}
+
+#ifndef SOMETHING_RELEASE
+// NOTE: reloads only the asset or the rooms that were loaded from the
+// file at `path`. Files that nothing was loaded from are ignored.
+void hot_reload_file(SDL_Renderer *renderer, const char *path)
+{
+    // NOTE: the asset may be deleted or moved away while the game
+    // runs. Its loader aborts on a missing file, and the old version
+    // is as good as anything until a new one shows up.
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        println(stderr, "[WARN] Not reloading `", path, "`: ", strerror(errno));
+        return;
+    }
+    fclose(f);
+
+    const String_View path_sv = cstr_as_string_view(path);
+
+    auto texture = assets.get_texture_by_path(path_sv);
+    if (texture.has_value) {
+        assets.reload_texture(renderer, texture.unwrap);
+        bake_tile_particle_palettes();
+        game.popup.notify(FONT_SUCCESS_COLOR, "Reloaded texture\n\n%s", path);
+        return;
+    }
+
+    auto sound = assets.get_sound_by_path(path_sv);
+    if (sound.has_value) {
+        // NOTE: see the F6 handler for why
+        game.mixer.stop_all();
+        game.mixer.sync();
+        assets.reload_sound(sound.unwrap);
+        game.popup.notify(FONT_SUCCESS_COLOR, "Reloaded sound\n\n%s", path);
+        return;
+    }
+
+    auto animat = assets.get_animat_by_path(path_sv);
+    if (animat.has_value) {
+        assets.reload_animat(animat.unwrap);
+        game.popup.notify(FONT_SUCCESS_COLOR, "Reloaded animat\n\n%s", path);
+        return;
+    }
+
+    // NOTE: the rooms that were edited since they were placed keep
+    // their own copy of the tiles and are not affected
+    auto room = game.grid.get_room_template_by_path(path);
+    if (room.has_value) {
+        game.grid.reload_room_template(room.unwrap);
+        game.popup.notify(FONT_SUCCESS_COLOR, "Reloaded room\n\n%s", path);
+        return;
+    }
+}
+#endif // SOMETHING_RELEASE
+
 int main(int argc, char *argv[])
 {
-    (void) argc;
-    (void) argv;
+    if (argc >= 2 && strcmp(argv[1], "--render-audio") == 0) {
+        if (argc < 4) {
+            println(stderr, "Usage: ", argv[0], " --render-audio <script.txt> <output.wav>");
+            return 1;
+        }
+        return render_audio_offline(argv[2], argv[3]);
+    }
+
+    const char *record_path = NULL;
+    const char *replay_path = NULL;
+    const char *hash_log_path = NULL;
+    const char *hash_check_path = NULL;
+    bool headless = false;
+    bool usage = false;
+    for (int i = 1; i < argc && !usage; ++i) {
+        if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            record_path = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replay_path = argv[++i];
+        } else if (strcmp(argv[i], "--hash-log") == 0 && i + 1 < argc) {
+            hash_log_path = argv[++i];
+        } else if (strcmp(argv[i], "--hash-check") == 0 && i + 1 < argc) {
+            hash_check_path = argv[++i];
+        } else if (strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+        } else {
+            usage = true;
+        }
+    }
+
+    // NOTE: the state hashes are only comparable between the runs of
+    // the same recording
+    usage = usage ||
+        (record_path != NULL && replay_path != NULL) ||
+        (headless && replay_path == NULL) ||
+        ((hash_log_path != NULL || hash_check_path != NULL) &&
+         record_path == NULL && replay_path == NULL);
+    if (usage) {
+        println(stderr, "Usage: ", argv[0], " [--record <session.rec>] [--hash-log <hashes.txt>]");
+        println(stderr, "       ", argv[0], " --replay <session.rec> [--headless] [--hash-log <hashes.txt>] [--hash-check <reference.txt>]");
+        println(stderr, "       ", argv[0], " --render-audio <script.txt> <output.wav>");
+        return 1;
+    }
+
+    auto room_files = load_room_files_from_dir("./assets/rooms/");
+    const uint32_t rooms_hash = hash_room_files(room_files);
+
+    uint32_t seed = (uint32_t) time(NULL);
+    if (replay_path != NULL) {
+        if (!input_replayer.load(replay_path)) return 1;
+        if (input_replayer.rooms_hash != rooms_hash) {
+            println(stderr, replay_path, ": the recording was made with a different set of rooms in ./assets/rooms/");
+            return 1;
+        }
+        seed = input_replayer.seed;
+    }
+    if (record_path != NULL && !input_recorder.start(record_path, seed, rooms_hash)) {
+        return 1;
+    }
+    game.seed_rngs(seed);
+    if (!state_hash_log.start(hash_log_path, hash_check_path)) {
+        return 1;
+    }
 
     sec(SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO));
+    profile_thread_name("Main");
 
+    // NOTE: the headless replay still needs a renderer to load the
+    // assets, but never shows it. Use SDL_VIDEODRIVER=dummy on the
+    // machines without a display.
     SDL_Window *window =
         sec(SDL_CreateWindow(
                 "Something",
                 0, 0, (int) SCREEN_WIDTH, (int) SCREEN_HEIGHT,
-                SDL_WINDOW_RESIZABLE));
+                headless ? SDL_WINDOW_HIDDEN : SDL_WINDOW_RESIZABLE));
 
+    const Uint32 renderer_flags = headless
+        ? (Uint32) SDL_RENDERER_SOFTWARE
+        : (Uint32) (SDL_RENDERER_PRESENTVSYNC | SDL_RENDERER_ACCELERATED);
     SDL_Renderer *renderer =
-        sec(SDL_CreateRenderer(
-                window, -1,
-                SDL_RENDERER_PRESENTVSYNC | SDL_RENDERER_ACCELERATED));
+        sec(SDL_CreateRenderer(window, -1, renderer_flags));
 
     assets.load_conf(renderer, "./assets/assets.conf");
 
@@ -61,8 +226,8 @@ int main(int argc, char *argv[])
     // TODO(#8): replace fantasy_tiles.png with our own assets
     auto tileset_texture = assets.get_texture_by_id_or_panic("FANTASY_TEXTURE"_sv);
 
-    game.mixer.volume = 0.2f;
-    game.keyboard = SDL_GetKeyboardState(NULL);
+    game.mixer.set_volume(0.2f);
+    game.keyboard = replay_path != NULL ? input_replayer.keyboard : SDL_GetKeyboardState(NULL);
 
     game.popup.font.bitmap = load_texture_from_bmp_file(renderer, "./assets/fonts/charmap-oldschool.bmp", {0, 0, 0, 255});
     game.debug_font.bitmap = game.popup.font.bitmap;
@@ -125,6 +290,8 @@ int main(int argc, char *argv[])
     };
     tile_defs[TILE_ICE_3].top_texture = tile_defs[TILE_ICE_3].bottom_texture;
 
+    bake_tile_particle_palettes();
+
     game.background.layers[0] = sprite_from_texture_index(assets.get_texture_by_id_or_panic("BACKGROUND_LIGHTS_TEXTURE"_sv));
     game.background.layers[1] = sprite_from_texture_index(assets.get_texture_by_id_or_panic("BACKGROUND_MIDDLE_TEXTURE"_sv));
     game.background.layers[2] = sprite_from_texture_index(assets.get_texture_by_id_or_panic("BACKGROUND_FRONT_TEXTURE"_sv));
@@ -138,7 +305,13 @@ int main(int argc, char *argv[])
         }
     }
 
-    auto fmw = fmw_init(VARS_CONF_FILE_PATH);
+    auto fmw = fmw_init();
+    const int vars_conf_watch = fmw_watch(fmw, VARS_CONF_FILE_PATH);
+    fmw_watch(fmw, "./assets/sprites/");
+    fmw_watch(fmw, "./assets/sounds/");
+    fmw_watch(fmw, "./assets/animats/");
+    fmw_watch(fmw, "./assets/rooms/");
+    static Fmw_Event fmw_events[FMW_EVENTS_CAPACITY];
 #endif // SOMETHING_RELEASE
 
     static_assert(DEBUG_TOOLBAR_COUNT <= TOOLBAR_BUTTONS_CAPACITY);
@@ -208,37 +381,69 @@ int main(int argc, char *argv[])
     want.userdata = &game.mixer;
 
     SDL_AudioSpec have = {};
-    SDL_AudioDeviceID dev = SDL_OpenAudioDevice(
-        NULL,
-        0,
-        &want,
-        &have,
-        0);
-    defer(SDL_CloseAudioDevice(dev));
-    if (dev == 0) {
-        println(stderr, "SDL pooped itself: Failed to open audio: ", SDL_GetError());
-        abort();
-    }
-    if (have.format != want.format) {
-        println(stderr, "[WARN] We didn't get expected audio format.");
-        abort();
+    SDL_AudioDeviceID dev = 0;
+    defer(if (dev != 0) SDL_CloseAudioDevice(dev));
+    // NOTE: the headless replay goes without the audio device, the
+    // game thread applies the mixer commands itself (see
+    // Sample_Mixer::no_device)
+    game.mixer.no_device = headless;
+    if (!headless) {
+        dev = SDL_OpenAudioDevice(
+            NULL,
+            0,
+            &want,
+            &have,
+            0);
+        if (dev == 0) {
+            println(stderr, "SDL pooped itself: Failed to open audio: ", SDL_GetError());
+            abort();
+        }
+        if (have.format != want.format) {
+            println(stderr, "[WARN] We didn't get expected audio format.");
+            abort();
+        }
+        SDL_PauseAudioDevice(dev, 0);
     }
-    SDL_PauseAudioDevice(dev, 0);
     // SOUND END //////////////////////////////
 
     game.reset_entities();
 
-    auto room_files = load_room_files_from_dir("./assets/rooms/");
+    const bool deterministic = record_path != NULL || replay_path != NULL;
+    if (deterministic) {
+        remove_room_saves(INPUT_RECORDING_SAVE_DIR);
+    }
+    world_streamer.synchronous = deterministic;
+
+    // NOTE: the normal runs keep playing the world of the previous
+    // ones, because their rooms are saved in WORLD_STREAMER_SAVE_DIR
+    const uint32_t world_seed =
+        deterministic ? seed : load_world_seed(WORLD_STREAMER_SAVE_DIR, seed);
+
+    world_streamer.start(&game.grid, room_files, world_seed,
+                         deterministic ? INPUT_RECORDING_SAVE_DIR : WORLD_STREAMER_SAVE_DIR);
+    world_streamer.load_now(&game, game.entities[PLAYER_ENTITY_INDEX].pos);
+    memory_stats.sample(&game);
+
+    if (headless) {
+        const Uint64 begin = SDL_GetPerformanceCounter();
+        while (!game.quit && input_replayer.next_tick(&game)) {
+            simulate_tick();
+            game.mixer.process_commands();
+        }
+        const float ms = (float) (SDL_GetPerformanceCounter() - begin) * 1000.0f / (float) SDL_GetPerformanceFrequency();
 
-    const int PADDING = 1;
-    for (int y = 0; y < 10; ++y) {
-        for (int x = 0; x < 10; ++x) {
-            const auto coord = vec2(x * (ROOM_WIDTH + PADDING), y * (ROOM_HEIGHT + PADDING));
-            const size_t room_index = rand() % room_files.size;
-            game.grid.load_room_from_file(room_files.data[room_index].data, coord);
-            game.add_camera_lock(rect(coord, ROOM_WIDTH, ROOM_HEIGHT));
+        println(stdout, "Replayed ", input_replayer.ticks, " ticks in ", ms, " ms");
+        if (input_replayer.ticks > 0) {
+            println(stdout, "  ", ms / (float) input_replayer.ticks, " ms per tick");
         }
+
+        world_streamer.stop(&game);
+        input_replayer.unload();
+        state_hash_log.stop();
+        SDL_Quit();
+        return state_hash_log.diverged ? 1 : 0;
     }
+    bool replaying = replay_path != NULL;
 
     sec(SDL_SetRenderDrawBlendMode(
             renderer,
@@ -250,6 +455,7 @@ int main(int argc, char *argv[])
     size_t frames_of_current_second = 0;
     size_t fps = 0;
     while (!game.quit) {
+        PROFILE_ZONE("Frame");
         Uint32 curr_ticks = SDL_GetTicks();
         float elapsed_sec = (float) (curr_ticks - prev_ticks) / 1000.0f;
         if(game.fps_debug) {
@@ -264,91 +470,177 @@ int main(int argc, char *argv[])
             fps = frames_of_current_second;
             next_sec -= 1.0f;
             frames_of_current_second = 0;
+            memory_stats.sample(&game);
         }
 
         prev_ticks = curr_ticks;
         lag_sec += elapsed_sec;
 
         //// HANDLE INPUT //////////////////////////////
-        SDL_Event event;
-        while (SDL_PollEvent(&event)) {
-            switch (event.type) {
-            case SDL_KEYDOWN: {
-                switch (event.key.keysym.sym) {
-                case SDLK_x: {
-                    if (game.step_debug) {
-                        game.update(SIMULATION_DELTA_TIME);
+        {
+            PROFILE_ZONE("Input");
+            SDL_Event event;
+            while (SDL_PollEvent(&event)) {
+                // NOTE: the recording is the only input while it is replayed
+                if (replaying) {
+                    if (event.type == SDL_QUIT) {
+                        game.quit = true;
                     }
-                } break;
+                    continue;
+                }
 
-                case SDLK_F6: {
-                    // NOTE: it is important to clean all of the
-                    // samples from the mixer before reloading the
-                    // assets, because after assets are reloaded any
-                    // pointers stored in the mixer could be
-                    // invalidated.
-                    game.mixer.clean();
-                    assets.load_conf(renderer, "./assets/assets.conf");
-                    game.popup.notify(FONT_SUCCESS_COLOR, "Reloaded assets file");
+                switch (event.type) {
+                case SDL_KEYDOWN: {
+                    switch (event.key.keysym.sym) {
+                    case SDLK_x: {
+                        if (game.step_debug) {
+                            simulate_tick();
+                        }
+                    } break;
+
+                    case SDLK_F6: {
+                        // NOTE: it is important to stop all of the
+                        // samples in the mixer and wait until the audio
+                        // thread is done with them before reloading the
+                        // assets, because after assets are reloaded any
+                        // pointers stored in the mixer could be
+                        // invalidated.
+                        game.mixer.stop_all();
+                        game.mixer.sync();
+                        assets.load_conf(renderer, "./assets/assets.conf");
+                        bake_tile_particle_palettes();
+                        game.popup.notify(FONT_SUCCESS_COLOR, "Reloaded assets file");
+                    } break;
+
+                    case SDLK_F9: {
+                        const Uint64 begin = SDL_GetPerformanceCounter();
+                        if (!save_game_snapshot(&game, &world_streamer, &quicksave)) {
+                            game.popup.notify(FONT_FAILURE_COLOR, "Quicksave does not fit into the snapshot");
+                            break;
+                        }
+                        const float ms = (float) (SDL_GetPerformanceCounter() - begin) * 1000.0f / (float) SDL_GetPerformanceFrequency();
+
+                        const int err = save_game_snapshot_to_file(QUICKSAVE_FILE_PATH, &quicksave);
+                        if (err != 0) {
+                            println(stderr, "Could not save `", QUICKSAVE_FILE_PATH, "`: ", strerror(err));
+                        }
+                        game.popup.notify(FONT_SUCCESS_COLOR, "Quicksaved\n\n%d KB in %.2f ms",
+                                          (int) (quicksave.size / 1024), ms);
+                    } break;
+
+                    case SDLK_F10: {
+                        if (input_recorder.file != NULL) {
+                            game.popup.notify(FONT_FAILURE_COLOR, "Quickload would break the input recording");
+                            break;
+                        }
+
+                        // NOTE: the file, so the quicksave survives a restart
+                        // of the same build
+                        const int err = load_game_snapshot_from_file(QUICKSAVE_FILE_PATH, &quicksave);
+                        if (err != 0) {
+                            game.popup.notify(FONT_FAILURE_COLOR, "Could not load %s: %s",
+                                              QUICKSAVE_FILE_PATH, strerror(err));
+                            break;
+                        }
+
+                        const Uint64 begin = SDL_GetPerformanceCounter();
+                        if (!restore_game_snapshot(&game, &world_streamer, &quicksave)) {
+                            game.popup.notify(FONT_FAILURE_COLOR, "Quicksave is corrupted or was made by a different build or world");
+                            break;
+                        }
+                        const float ms = (float) (SDL_GetPerformanceCounter() - begin) * 1000.0f / (float) SDL_GetPerformanceFrequency();
+                        game.popup.notify(FONT_SUCCESS_COLOR, "Quickloaded in %.2f ms", ms);
+                    } break;
+                    }
                 } break;
                 }
-            } break;
+
+                game.handle_event(&event);
+                input_recorder.record_event(&event);
             }
 
-            game.handle_event(&event);
-        }
+    #ifndef SOMETHING_RELEASE
+            const size_t fmw_events_count = fmw_poll(fmw, fmw_events, FMW_EVENTS_CAPACITY);
+            for (size_t i = 0; i < fmw_events_count; ++i) {
+                if (fmw_events[i].watch != vars_conf_watch) {
+                    hot_reload_file(renderer, fmw_events[i].path);
+                    continue;
+                }
 
-#ifndef SOMETHING_RELEASE
-        if (fmw_poll(fmw)) {
-            auto result = reload_config_file(VARS_CONF_FILE_PATH);
-            if (result.is_error) {
-                println(stderr, VARS_CONF_FILE_PATH, ":", result.line, ": ", result.message);
-                game.popup.notify(FONT_FAILURE_COLOR, "%s:%d: %s", VARS_CONF_FILE_PATH, result.line, result.message);
-            } else {
-                game.popup.notify(FONT_SUCCESS_COLOR, "Reloaded config file\n\n%s", VARS_CONF_FILE_PATH);
+                auto result = reload_config_file(VARS_CONF_FILE_PATH);
+                if (result.is_error) {
+                    println(stderr, VARS_CONF_FILE_PATH, ":", result.line, ": ", result.message);
+                    game.popup.notify(FONT_FAILURE_COLOR, "%s:%d: %s", VARS_CONF_FILE_PATH, result.line, result.message);
+                } else {
+                    for (size_t j = 0; j < config_changed_count; ++j) {
+                        println(stdout, "Config variable ", config_names[config_changed_indices[j]], " changed");
+                    }
+                    game.popup.notify(FONT_SUCCESS_COLOR, "Reloaded config file\n\n%s\n\n%d variable(s) changed",
+                                      VARS_CONF_FILE_PATH, (int) config_changed_count);
+                }
             }
+    #endif // SOMETHING_RELEASE
         }
-#endif // SOMETHING_RELEASE
         //// HANDLE INPUT END //////////////////////////////
 
         //// UPDATE STATE //////////////////////////////
-        if (!game.step_debug) {
-            SDL_Delay(1);
-            while (lag_sec >= SIMULATION_DELTA_TIME) {
-                game.update(SIMULATION_DELTA_TIME);
-                lag_sec -= SIMULATION_DELTA_TIME;
+        {
+            PROFILE_ZONE("Update");
+            if (replaying) {
+                SDL_Delay(1);
+                while (replaying && lag_sec >= SIMULATION_DELTA_TIME) {
+                    if (input_replayer.next_tick(&game)) {
+                        simulate_tick();
+                    } else {
+                        replaying = false;
+                        game.keyboard = SDL_GetKeyboardState(NULL);
+                        game.popup.notify(FONT_SUCCESS_COLOR, "Replay is over after %d ticks",
+                                          (int) input_replayer.ticks);
+                    }
+                    lag_sec -= SIMULATION_DELTA_TIME;
+                }
+            } else if (!game.step_debug) {
+                SDL_Delay(1);
+                while (lag_sec >= SIMULATION_DELTA_TIME) {
+                    simulate_tick();
+                    lag_sec -= SIMULATION_DELTA_TIME;
+                }
             }
         }
         //// UPDATE STATE END //////////////////////////////
 
         //// RENDER //////////////////////////////
-        const SDL_Color background_color = rgba_to_sdl(BACKGROUND_COLOR);
-        sec(SDL_SetRenderDrawColor(
-                renderer,
-                background_color.r,
-                background_color.g,
-                background_color.b,
-                background_color.a));
-        sec(SDL_RenderClear(renderer));
-        const SDL_Color canvas_background_color = rgba_to_sdl(CANVAS_BACKGROUND_COLOR);
-        sec(SDL_SetRenderDrawColor(
-                renderer,
-                canvas_background_color.r,
-                canvas_background_color.g,
-                canvas_background_color.b,
-                canvas_background_color.a));
         {
-            SDL_Rect canvas = {0, 0, (int) floorf(SCREEN_WIDTH), (int) floorf(SCREEN_HEIGHT)};
-            SDL_RenderFillRect(renderer, &canvas);
+            PROFILE_ZONE("Render");
+            render_stats.begin_frame();
+            render_draw_color(renderer, rgba_to_sdl(BACKGROUND_COLOR));
+            render_clear(renderer);
+            render_draw_color(renderer, rgba_to_sdl(CANVAS_BACKGROUND_COLOR));
+            {
+                SDL_Rect canvas = {0, 0, (int) floorf(SCREEN_WIDTH), (int) floorf(SCREEN_HEIGHT)};
+                render_fill_rect(renderer, &canvas);
+            }
+            game.render(renderer);
+            if (game.debug) {
+                game.render_debug_overlay(renderer, fps);
+            }
         }
-        game.render(renderer);
-        if (game.debug) {
-            game.render_debug_overlay(renderer, fps);
+
+        // NOTE: waits for the vsync
+        {
+            PROFILE_ZONE("Present");
+            SDL_RenderPresent(renderer);
         }
-        SDL_RenderPresent(renderer);
+        render_stats.end_frame();
         //// RENDER END //////////////////////////////
     }
 
+    world_streamer.stop(&game);
+    input_recorder.stop();
+    input_replayer.unload();
+    state_hash_log.stop();
+    render_stats.stop_export();
+
     SDL_Quit();
 
     return 0;
@@ -234,8 +234,48 @@ Vec2f polar(float mag, float angle)
     return vec2(cosf(angle), sinf(angle)) * mag;
 }
 
-float rand_float_range(float low, float high)
+// NOTE: PCG32 (https://www.pcg-random.org/). Every stream has its own
+// increment, so the streams made from the same seed do not overlap and
+// the systems using them do not shift each other's sequences.
+struct Rng
 {
-    const auto r = (float)rand()/(float)(RAND_MAX);
-    return low + r * (high - low);
+    uint64_t state;
+    uint64_t inc;
+
+    uint32_t next()
+    {
+        const uint64_t old = state;
+        state = old * 6364136223846793005ULL + inc;
+        const uint32_t xorshifted = (uint32_t) (((old >> 18u) ^ old) >> 27u);
+        const uint32_t rot = (uint32_t) (old >> 59u);
+        return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+    }
+
+    // NOTE: [0, n)
+    uint32_t below(uint32_t n)
+    {
+        assert(n > 0);
+        return (uint32_t) (((uint64_t) next() * n) >> 32);
+    }
+
+    // NOTE: [0, 1)
+    float next_float()
+    {
+        return (float) (next() >> 8) * (1.0f / 16777216.0f);
+    }
+
+    float range(float low, float high)
+    {
+        return low + next_float() * (high - low);
+    }
+};
+
+Rng make_rng(uint64_t seed, uint64_t stream)
+{
+    Rng rng = {};
+    rng.inc = (stream << 1u) | 1u;
+    rng.next();
+    rng.state += seed;
+    rng.next();
+    return rng;
 }
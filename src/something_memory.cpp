@@ -0,0 +1,128 @@
+#include "./something_memory.hpp"
+
+Memory_Stats memory_stats = {};
+
+static size_t surface_bytes(const SDL_Surface *surface)
+{
+    if (surface == NULL) return 0;
+    return (size_t) surface->h * (size_t) surface->pitch;
+}
+
+static size_t texture_bytes(SDL_Texture *texture)
+{
+    if (texture == NULL) return 0;
+    int w = 0;
+    int h = 0;
+    sec(SDL_QueryTexture(texture, NULL, NULL, &w, &h));
+    // NOTE: all the textures of the game are RGBA32
+    return (size_t) w * (size_t) h * 4;
+}
+
+void Memory_Stats::sample(Game *game)
+{
+    memset(usages, 0, sizeof(usages));
+
+    // Game //////////////////////////////
+    usages[MEMORY_SUBSYSTEM_TILES].static_bytes = sizeof(game->grid.tiles);
+    usages[MEMORY_SUBSYSTEM_WORLD].static_bytes = sizeof(game->grid) - sizeof(game->grid.tiles);
+    usages[MEMORY_SUBSYSTEM_PARTICLES].static_bytes = sizeof(Particles) * ENTITIES_COUNT;
+    usages[MEMORY_SUBSYSTEM_ENTITIES].static_bytes =
+        sizeof(game->entities) - sizeof(Particles) * ENTITIES_COUNT +
+        sizeof(game->projectiles) +
+        sizeof(game->animat_playbacks) +
+        sizeof(game->items);
+    usages[MEMORY_SUBSYSTEM_AUDIO].static_bytes = sizeof(game->mixer);
+    usages[MEMORY_SUBSYSTEM_CONSOLE].static_bytes = sizeof(game->console);
+    usages[MEMORY_SUBSYSTEM_UI].static_bytes =
+        sizeof(game->popup) +
+        sizeof(game->debug_font) +
+        sizeof(game->debug_toolbar) +
+        sizeof(game->frame_delays);
+
+    // NOTE: the rest of Game goes to `other`, so the static bytes
+    // always add up to sizeof(Game)
+    size_t game_attributed = 0;
+    for (size_t i = 0; i < MEMORY_SUBSYSTEMS_COUNT; ++i) {
+        game_attributed += usages[i].static_bytes;
+    }
+    assert(game_attributed <= sizeof(*game));
+    usages[MEMORY_SUBSYSTEM_OTHER].static_bytes = sizeof(*game) - game_attributed;
+
+    // NOTE: the popup and the debug font share the bitmap
+    usages[MEMORY_SUBSYSTEM_UI].texture_bytes += texture_bytes(game->popup.font.bitmap);
+
+    // Assets //////////////////////////////
+    usages[MEMORY_SUBSYSTEM_ASSETS].static_bytes += sizeof(assets);
+    for (size_t i = 0; i < assets.textures_count; ++i) {
+        const Texture *texture = &assets.textures[i].unwrap;
+        usages[MEMORY_SUBSYSTEM_ASSETS].heap_bytes +=
+            surface_bytes(texture->surface) + surface_bytes(texture->surface_mask);
+        usages[MEMORY_SUBSYSTEM_ASSETS].texture_bytes +=
+            texture_bytes(texture->texture) + texture_bytes(texture->texture_mask);
+    }
+    for (size_t i = 0; i < assets.sounds_count; ++i) {
+        usages[MEMORY_SUBSYSTEM_AUDIO].heap_bytes +=
+            assets.sounds[i].unwrap.audio_len * sizeof(int16_t);
+    }
+    for (size_t i = 0; i < assets.animats_count; ++i) {
+        usages[MEMORY_SUBSYSTEM_ASSETS].heap_bytes +=
+            assets.animats[i].unwrap.frame_count * sizeof(Sprite);
+    }
+
+    // The rest of the globals //////////////////////////////
+    usages[MEMORY_SUBSYSTEM_WORLD].static_bytes += sizeof(world_streamer);
+    usages[MEMORY_SUBSYSTEM_SNAPSHOTS].static_bytes += sizeof(quicksave);
+    usages[MEMORY_SUBSYSTEM_REPLAY].static_bytes +=
+        sizeof(input_recorder) + sizeof(input_replayer) + sizeof(state_hash_log);
+    if (input_replayer.data != NULL) {
+        usages[MEMORY_SUBSYSTEM_REPLAY].heap_bytes += input_replayer.size;
+    }
+    usages[MEMORY_SUBSYSTEM_PROFILER].static_bytes += sizeof(profiler_threads);
+    usages[MEMORY_SUBSYSTEM_OTHER].static_bytes += sizeof(render_stats);
+#ifndef SOMETHING_RELEASE
+    usages[MEMORY_SUBSYSTEM_CONFIG].static_bytes +=
+        sizeof(config_file_buffer) + sizeof(config_values) + sizeof(config_error_buffer);
+#endif // SOMETHING_RELEASE
+
+    size_t sum = 0;
+    for (size_t i = 0; i < MEMORY_SUBSYSTEMS_COUNT; ++i) {
+        peaks[i] = max(peaks[i], usages[i].total());
+        sum += usages[i].total();
+    }
+    total_peak = max(total_peak, sum);
+    samples += 1;
+}
+
+Memory_Usage Memory_Stats::total() const
+{
+    Memory_Usage result = {};
+    for (size_t i = 0; i < MEMORY_SUBSYSTEMS_COUNT; ++i) {
+        result.static_bytes += usages[i].static_bytes;
+        result.heap_bytes += usages[i].heap_bytes;
+        result.texture_bytes += usages[i].texture_bytes;
+    }
+    return result;
+}
+
+void Memory_Stats::format_header(char *buffer, size_t buffer_size) const
+{
+    snprintf(buffer, buffer_size, "%-10s %9s%9s%9s%9s%9s",
+             "(MB)", "static", "heap", "textures", "total", "peak");
+}
+
+void Memory_Stats::format_row(size_t index, char *buffer, size_t buffer_size) const
+{
+    assert(index <= MEMORY_SUBSYSTEMS_COUNT);
+    const bool is_total = index == MEMORY_SUBSYSTEMS_COUNT;
+    const Memory_Usage usage = is_total ? total() : usages[index];
+    const size_t peak = is_total ? total_peak : peaks[index];
+    const double MB = 1024.0 * 1024.0;
+
+    snprintf(buffer, buffer_size, "%-10s %9.2f%9.2f%9.2f%9.2f%9.2f",
+             is_total ? "total" : memory_subsystem_names[index],
+             (double) usage.static_bytes / MB,
+             (double) usage.heap_bytes / MB,
+             (double) usage.texture_bytes / MB,
+             (double) usage.total() / MB,
+             (double) peak / MB);
+}
@@ -0,0 +1,79 @@
+#ifndef SOMETHING_MEMORY_HPP_
+#define SOMETHING_MEMORY_HPP_
+
+enum Memory_Subsystem
+{
+    MEMORY_SUBSYSTEM_TILES = 0,
+    MEMORY_SUBSYSTEM_WORLD,
+    MEMORY_SUBSYSTEM_ENTITIES,
+    MEMORY_SUBSYSTEM_PARTICLES,
+    MEMORY_SUBSYSTEM_AUDIO,
+    MEMORY_SUBSYSTEM_ASSETS,
+    MEMORY_SUBSYSTEM_UI,
+    MEMORY_SUBSYSTEM_CONSOLE,
+    MEMORY_SUBSYSTEM_CONFIG,
+    MEMORY_SUBSYSTEM_SNAPSHOTS,
+    MEMORY_SUBSYSTEM_REPLAY,
+    MEMORY_SUBSYSTEM_PROFILER,
+    MEMORY_SUBSYSTEM_OTHER,
+    MEMORY_SUBSYSTEMS_COUNT
+};
+
+const char *const memory_subsystem_names[MEMORY_SUBSYSTEMS_COUNT] = {
+    "tiles",
+    "world",
+    "entities",
+    "particles",
+    "audio",
+    "assets",
+    "ui",
+    "console",
+    "config",
+    "snapshots",
+    "replay",
+    "profiler",
+    "other",
+};
+
+struct Memory_Usage
+{
+    // NOTE: the globals, which take their memory whether it is used or not
+    size_t static_bytes;
+    // NOTE: the long lived allocations: samples, animation frames,
+    // surfaces, the world file and the recordings. The temporary ones
+    // that are freed in the same function are not counted.
+    size_t heap_bytes;
+    // NOTE: the pixels of the SDL textures, which are in the video
+    // memory or, with the software renderer, on the heap of SDL
+    size_t texture_bytes;
+
+    size_t total() const
+    {
+        return static_bytes + heap_bytes + texture_bytes;
+    }
+};
+
+// NOTE: the memory is not tracked at the allocations. The owners are
+// walked every time the stats are sampled, which is cheap enough to do
+// every second, so the high-water marks only see what lives at least
+// that long.
+struct Memory_Stats
+{
+    Memory_Usage usages[MEMORY_SUBSYSTEMS_COUNT];
+    // NOTE: the high-water marks of Memory_Usage::total()
+    size_t peaks[MEMORY_SUBSYSTEMS_COUNT];
+    size_t total_peak;
+    uint64_t samples;
+
+    void sample(Game *game);
+    Memory_Usage total() const;
+
+    // NOTE: the rows of the report, aligned for the monospace fonts.
+    // `index` == MEMORY_SUBSYSTEMS_COUNT is the total.
+    void format_header(char *buffer, size_t buffer_size) const;
+    void format_row(size_t index, char *buffer, size_t buffer_size) const;
+};
+
+extern Memory_Stats memory_stats;
+
+#endif  // SOMETHING_MEMORY_HPP_
@@ -3,33 +3,74 @@
 
 void Particles::render(SDL_Renderer *renderer, Camera camera) const
 {
-    for (size_t i = 0; i < count; ++i) {
-        const size_t j = (begin + i) % PARTICLES_CAPACITY;
-        if (lifetimes[j] > 0.0f) {
-            const Rectf particle = rect(
-                positions[j] - vec2(sizes[j], sizes[j]) * 0.5f,
-                sizes[j], sizes[j]);
-            const auto opacity = lifetimes[j] / PARTICLE_LIFETIME;
-            fill_rect(renderer, camera.to_screen(particle),
-                      {colors[j].r, colors[j].g, colors[j].b, colors[j].a * opacity});
+    Render_Subsystem_Scope scope(RENDER_SUBSYSTEM_PARTICLES);
+
+    RGBA rgbas[PARTICLES_BATCH_SIZE];
+    SDL_Color sdl_colors[PARTICLES_BATCH_SIZE];
+    SDL_Rect rects[PARTICLES_BATCH_SIZE];
+
+    for (size_t i = 0; i < count;) {
+        size_t n = 0;
+        for (; i < count && n < PARTICLES_BATCH_SIZE; ++i) {
+            const size_t j = (begin + i) % PARTICLES_CAPACITY;
+            if (lifetimes[j] > 0.0f) {
+                const Rectf particle = camera.to_screen(rect(
+                    positions[j] - vec2(sizes[j], sizes[j]) * 0.5f,
+                    sizes[j], sizes[j]));
+                rects[n] = {
+                    (int) floorf(particle.x),
+                    (int) floorf(particle.y),
+                    (int) floorf(particle.w),
+                    (int) floorf(particle.h),
+                };
+                rgbas[n] = colors[j];
+                rgbas[n].a *= lifetimes[j] / PARTICLE_LIFETIME;
+                n += 1;
+            }
+        }
+
+        rgba_to_sdl_batch(rgbas, sdl_colors, n);
+
+        for (size_t k = 0; k < n; ++k) {
+            render_draw_color(renderer, sdl_colors[k]);
+            render_fill_rect(renderer, &rects[k]);
         }
     }
 }
 
+void Particles::push(float impact, Rng *rng)
+{
+    push_burst(1, impact, impact, rng);
+}
 
-void Particles::push(float impact)
+void Particles::push_burst(size_t n, float impact_low, float impact_high, Rng *rng)
 {
-    if (count < PARTICLES_CAPACITY) {
-        const size_t j = (begin + count) % PARTICLES_CAPACITY;
-        positions[j] = source;
-        velocities[j] = polar(impact, rand_float_range(PI, 2.0f * PI));
-        lifetimes[j] = PARTICLE_LIFETIME;
-        sizes[j] = rand_float_range(PARTICLE_SIZE_LOW, PARTICLE_SIZE_HIGH);
-        // TODO(#187): implement HSL based generation of color for particles
-        HSLA hsla = current_color;
-        hsla.h += rand_float_range(0.0f, 2.0f * PARTICLES_HUE_DEVIATION_DEGREE) - PARTICLES_HUE_DEVIATION_DEGREE;
-        colors[j] = hsla.to_rgba();
-        count += 1;
+    HSLA hslas[PARTICLES_BATCH_SIZE];
+    RGBA rgbas[PARTICLES_BATCH_SIZE];
+
+    n = min(n, PARTICLES_CAPACITY - count);
+
+    while (n > 0) {
+        const size_t m = min(n, PARTICLES_BATCH_SIZE);
+
+        for (size_t i = 0; i < m; ++i) {
+            const size_t j = (begin + count + i) % PARTICLES_CAPACITY;
+            positions[j] = source;
+            velocities[j] = polar(rng->range(impact_low, impact_high), rng->range(PI, 2.0f * PI));
+            lifetimes[j] = PARTICLE_LIFETIME;
+            sizes[j] = rng->range(PARTICLE_SIZE_LOW, PARTICLE_SIZE_HIGH);
+            hslas[i] = current_color;
+            hslas[i].h += rng->range(0.0f, 2.0f * PARTICLES_HUE_DEVIATION_DEGREE) - PARTICLES_HUE_DEVIATION_DEGREE;
+        }
+
+        hsla_to_rgba_batch(hslas, rgbas, m);
+
+        for (size_t i = 0; i < m; ++i) {
+            colors[(begin + count + i) % PARTICLES_CAPACITY] = rgbas[i];
+        }
+
+        count += m;
+        n -= m;
     }
 }
 
@@ -40,7 +81,7 @@ void Particles::pop()
     count -= 1;
 }
 
-void Particles::update(float dt, Tile_Grid *grid)
+void Particles::update(float dt, Tile_Grid *grid, Rng *rng)
 {
 
     for (size_t i = 0; i < count; ++i) {
@@ -62,7 +103,7 @@ void Particles::update(float dt, Tile_Grid *grid)
     cooldown -= dt;
 
     if (cooldown <= 0.0f && state == Particles::EMITTING) {
-        push(rand_float_range(PARTICLE_VEL_LOW, PARTICLE_VEL_HIGH));
+        push(rng->range(PARTICLE_VEL_LOW, PARTICLE_VEL_HIGH), rng);
         const float PARTICLE_COOLDOWN = 1.0f / PARTICLES_RATE;
         cooldown = PARTICLE_COOLDOWN;
     }
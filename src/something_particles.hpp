@@ -2,6 +2,9 @@
 #define SOMETHING_PARTICLES_HPP_
 
 const size_t PARTICLES_CAPACITY = 1024;
+// NOTE: how many particles are pushed or rendered per batched color
+// conversion
+const size_t PARTICLES_BATCH_SIZE = 64;
 
 struct Particles
 {
@@ -25,8 +28,9 @@ struct Particles
     size_t count;
 
     void render(SDL_Renderer *renderer, Camera camera) const;
-    void update(float dt, Tile_Grid *grid);
-    void push(float impact);
+    void update(float dt, Tile_Grid *grid, Rng *rng);
+    void push(float impact, Rng *rng);
+    void push_burst(size_t n, float impact_low, float impact_high, Rng *rng);
     void pop();
 };
 
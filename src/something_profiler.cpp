@@ -0,0 +1,155 @@
+#include "./something_profiler.hpp"
+
+Profiler_Thread profiler_threads[PROFILER_THREADS_CAPACITY] = {};
+SDL_atomic_t profiler_threads_count = {};
+
+static thread_local bool profiler_thread_registered = false;
+static thread_local Profiler_Thread *profiler_current_thread = NULL;
+
+Profiler_Thread *profile_current_thread()
+{
+    if (!profiler_thread_registered) {
+        profiler_thread_registered = true;
+        const int index = SDL_AtomicAdd(&profiler_threads_count, 1);
+        if (index < (int) PROFILER_THREADS_CAPACITY) {
+            profiler_current_thread = &profiler_threads[index];
+        }
+    }
+
+    return profiler_current_thread;
+}
+
+static size_t profiler_threads_size()
+{
+    return min((size_t) SDL_AtomicGet(&profiler_threads_count), PROFILER_THREADS_CAPACITY);
+}
+
+void profile_thread_name(const char *name)
+{
+    Profiler_Thread *thread = profile_current_thread();
+    if (thread == NULL) return;
+    thread->name = name;
+}
+
+void profile_begin(const char *name)
+{
+    Profiler_Thread *thread = profile_current_thread();
+    if (thread == NULL) return;
+
+    if (thread->depth < PROFILER_DEPTH_CAPACITY) {
+        thread->open_names[thread->depth] = name;
+        thread->open_begins[thread->depth] = SDL_GetPerformanceCounter();
+    }
+    thread->depth += 1;
+}
+
+void profile_end()
+{
+    Profiler_Thread *thread = profile_current_thread();
+    if (thread == NULL) return;
+
+    assert(thread->depth > 0);
+    thread->depth -= 1;
+    if (thread->depth >= PROFILER_DEPTH_CAPACITY) return;
+
+    const uint32_t count = (uint32_t) SDL_AtomicGet(&thread->count);
+    Profile_Event *event = &thread->events[count % PROFILER_EVENTS_CAPACITY];
+    event->name = thread->open_names[thread->depth];
+    event->begin = thread->open_begins[thread->depth];
+    event->end = SDL_GetPerformanceCounter();
+    event->depth = thread->depth;
+    // NOTE: SDL_AtomicAdd is a full barrier, so the event is written
+    // before the other threads can see the new count
+    SDL_AtomicAdd(&thread->count, 1);
+}
+
+size_t profile_last_root(Profiler_Thread *thread, Profile_Event *events, size_t capacity)
+{
+    const uint32_t count = (uint32_t) SDL_AtomicGet(&thread->count);
+    const uint32_t available = min(count, (uint32_t) PROFILER_EVENTS_CAPACITY);
+
+    uint32_t i = 0;
+    while (i < available && thread->events[(count - 1 - i) % PROFILER_EVENTS_CAPACITY].depth != 0) {
+        ++i;
+    }
+    if (i >= available) return 0;
+
+    const Profile_Event root = thread->events[(count - 1 - i) % PROFILER_EVENTS_CAPACITY];
+    size_t size = 0;
+    events[size++] = root;
+
+    // NOTE: the zones nested in the root finish before it, so they are
+    // right before it in the ring
+    for (++i; i < available && size < capacity; ++i) {
+        const Profile_Event event = thread->events[(count - 1 - i) % PROFILER_EVENTS_CAPACITY];
+        if (event.depth == 0 || event.begin < root.begin) break;
+        events[size++] = event;
+    }
+
+    return size;
+}
+
+int profile_dump_chrome_trace(const char *filepath)
+{
+    // NOTE: the other threads keep writing while the rings are copied,
+    // so the oldest events, which may be overwritten in the meantime,
+    // are left out
+    const uint32_t PROFILER_DUMP_MARGIN = 1024;
+    const size_t threads_size = profiler_threads_size();
+
+    Profile_Event *events = (Profile_Event*) malloc(
+        sizeof(Profile_Event) * PROFILER_EVENTS_CAPACITY * PROFILER_THREADS_CAPACITY);
+    assert(events != NULL);
+    defer(free(events));
+    size_t events_sizes[PROFILER_THREADS_CAPACITY] = {};
+
+    Uint64 epoch = 0;
+    bool has_epoch = false;
+    for (size_t t = 0; t < threads_size; ++t) {
+        Profiler_Thread *thread = &profiler_threads[t];
+        Profile_Event *thread_events = events + t * PROFILER_EVENTS_CAPACITY;
+
+        const uint32_t count = (uint32_t) SDL_AtomicGet(&thread->count);
+        const uint32_t available = min(count, (uint32_t) (PROFILER_EVENTS_CAPACITY - PROFILER_DUMP_MARGIN));
+        for (uint32_t i = count - available; i != count; ++i) {
+            const Profile_Event event = thread->events[i % PROFILER_EVENTS_CAPACITY];
+            thread_events[events_sizes[t]++] = event;
+            if (!has_epoch || event.begin < epoch) {
+                epoch = event.begin;
+                has_epoch = true;
+            }
+        }
+    }
+
+    FILE *f = fopen(filepath, "w");
+    if (f == NULL) return errno;
+    defer(fclose(f));
+
+    const double us_per_tick = 1000000.0 / (double) SDL_GetPerformanceFrequency();
+    const char *separator = "";
+    fprintf(f, "{\"traceEvents\":[\n");
+    for (size_t t = 0; t < threads_size; ++t) {
+        const Profiler_Thread *thread = &profiler_threads[t];
+        if (thread->name != NULL) {
+            fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%zu,\"args\":{\"name\":\"%s\"}}",
+                    separator, t, thread->name);
+        } else {
+            fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%zu,\"args\":{\"name\":\"Thread %zu\"}}",
+                    separator, t, t);
+        }
+        separator = ",\n";
+
+        const Profile_Event *thread_events = events + t * PROFILER_EVENTS_CAPACITY;
+        for (size_t i = 0; i < events_sizes[t]; ++i) {
+            const Profile_Event *event = &thread_events[i];
+            fprintf(f, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%zu,\"ts\":%.3f,\"dur\":%.3f}",
+                    separator, event->name, t,
+                    (double) (event->begin - epoch) * us_per_tick,
+                    (double) (event->end - event->begin) * us_per_tick);
+        }
+    }
+    fprintf(f, "\n]}\n");
+
+    if (ferror(f)) return errno ? errno : EIO;
+    return 0;
+}
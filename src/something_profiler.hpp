@@ -0,0 +1,73 @@
+#ifndef SOMETHING_PROFILER_HPP_
+#define SOMETHING_PROFILER_HPP_
+
+const size_t PROFILER_THREADS_CAPACITY = 8;
+// NOTE: must be a power of two, so the ring index survives the wrap
+// around of the 32 bit event counter
+const size_t PROFILER_EVENTS_CAPACITY = 16 * 1024;
+const size_t PROFILER_DEPTH_CAPACITY = 32;
+const char *const PROFILER_TRACE_FILE_PATH = "./profile.json";
+static_assert((PROFILER_EVENTS_CAPACITY & (PROFILER_EVENTS_CAPACITY - 1)) == 0);
+
+struct Profile_Event
+{
+    // NOTE: string literals only, the pointer is stored as is
+    const char *name;
+    Uint64 begin;
+    Uint64 end;
+    uint32_t depth;
+};
+
+// NOTE: every thread writes the zones it has finished into its own
+// ring, so recording a zone never takes a lock. The readers on the
+// other threads only look at the events older than `count`, which is
+// published after the event is written.
+struct Profiler_Thread
+{
+    const char *name;
+    Profile_Event events[PROFILER_EVENTS_CAPACITY];
+    SDL_atomic_t count;
+
+    const char *open_names[PROFILER_DEPTH_CAPACITY];
+    Uint64 open_begins[PROFILER_DEPTH_CAPACITY];
+    uint32_t depth;
+};
+
+extern Profiler_Thread profiler_threads[PROFILER_THREADS_CAPACITY];
+extern SDL_atomic_t profiler_threads_count;
+
+// NOTE: the name shows up in the trace. Threads that never call it are
+// named by their index.
+void profile_thread_name(const char *name);
+// NOTE: NULL if there are more threads than PROFILER_THREADS_CAPACITY
+Profiler_Thread *profile_current_thread();
+void profile_begin(const char *name);
+void profile_end();
+
+// NOTE: copies the last finished zone with depth 0 on `thread` and
+// everything nested in it into `events`. Returns how many events were
+// copied. Used by the flame overlay to show the last frame.
+size_t profile_last_root(Profiler_Thread *thread, Profile_Event *events, size_t capacity);
+
+// NOTE: Chrome trace_event JSON. Open it in chrome://tracing or
+// https://ui.perfetto.dev/
+int profile_dump_chrome_trace(const char *filepath);
+
+struct Profile_Zone
+{
+    Profile_Zone(const char *name)
+    {
+        profile_begin(name);
+    }
+
+    ~Profile_Zone()
+    {
+        profile_end();
+    }
+};
+
+#define PROFILE_ZONE_1(x, y) x##y
+#define PROFILE_ZONE_2(x, y) PROFILE_ZONE_1(x, y)
+#define PROFILE_ZONE(name) Profile_Zone PROFILE_ZONE_2(_profile_zone_, __COUNTER__)(name)
+
+#endif  // SOMETHING_PROFILER_HPP_
@@ -1,24 +1,145 @@
 #include "something_render.hpp"
 
+Render_Stats render_stats = {};
+
+void Render_Stats::begin_frame()
+{
+    memset(frame, 0, sizeof(frame));
+    subsystem = RENDER_SUBSYSTEM_OTHER;
+    texture = NULL;
+}
+
+void Render_Stats::end_frame()
+{
+    memcpy(last, frame, sizeof(last));
+    frames += 1;
+
+    if (output != NULL) {
+        fprintf(output, "%llu", (unsigned long long) frames);
+        for (size_t i = 0; i < RENDER_SUBSYSTEMS_COUNT; ++i) {
+            fprintf(output, ",%u,%u,%u", last[i].draw_calls, last[i].state_changes, last[i].quads);
+        }
+        fputc('\n', output);
+    }
+}
+
+Render_Counters Render_Stats::last_total() const
+{
+    Render_Counters result = {};
+    for (size_t i = 0; i < RENDER_SUBSYSTEMS_COUNT; ++i) {
+        result = result + last[i];
+    }
+    return result;
+}
+
+bool Render_Stats::start_export(const char *filepath)
+{
+    stop_export();
+
+    output = fopen(filepath, "w");
+    if (output == NULL) return false;
+
+    fprintf(output, "frame");
+    for (size_t i = 0; i < RENDER_SUBSYSTEMS_COUNT; ++i) {
+        const char *name = render_subsystem_names[i];
+        fprintf(output, ",%s_draw_calls,%s_state_changes,%s_quads", name, name, name);
+    }
+    fputc('\n', output);
+    frames = 0;
+
+    return true;
+}
+
+void Render_Stats::stop_export()
+{
+    if (output != NULL) {
+        fclose(output);
+        output = NULL;
+    }
+}
+
+void render_draw_color(SDL_Renderer *renderer, SDL_Color color)
+{
+    render_stats.frame[render_stats.subsystem].state_changes += 1;
+    sec(SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a));
+}
+
+void render_texture_mod(SDL_Texture *texture, SDL_Color color)
+{
+    render_stats.frame[render_stats.subsystem].state_changes += 2;
+    sec(SDL_SetTextureColorMod(texture, color.r, color.g, color.b));
+    sec(SDL_SetTextureAlphaMod(texture, color.a));
+}
+
+void render_clear(SDL_Renderer *renderer)
+{
+    render_stats.frame[render_stats.subsystem].draw_calls += 1;
+    sec(SDL_RenderClear(renderer));
+}
+
+void render_fill_rect(SDL_Renderer *renderer, const SDL_Rect *rect)
+{
+    Render_Counters *counters = &render_stats.frame[render_stats.subsystem];
+    counters->draw_calls += 1;
+    counters->quads += 1;
+    sec(SDL_RenderFillRect(renderer, rect));
+}
+
+void render_draw_rect(SDL_Renderer *renderer, const SDL_Rect *rect)
+{
+    render_stats.frame[render_stats.subsystem].draw_calls += 1;
+    sec(SDL_RenderDrawRect(renderer, rect));
+}
+
+void render_draw_line(SDL_Renderer *renderer, int x1, int y1, int x2, int y2)
+{
+    render_stats.frame[render_stats.subsystem].draw_calls += 1;
+    sec(SDL_RenderDrawLine(renderer, x1, y1, x2, y2));
+}
+
+static void count_copy(SDL_Texture *texture)
+{
+    Render_Counters *counters = &render_stats.frame[render_stats.subsystem];
+    counters->draw_calls += 1;
+    counters->quads += 1;
+    if (texture != render_stats.texture) {
+        counters->state_changes += 1;
+        render_stats.texture = texture;
+    }
+}
+
+void render_copy(SDL_Renderer *renderer, SDL_Texture *texture,
+                 const SDL_Rect *srcrect, const SDL_Rect *dstrect)
+{
+    count_copy(texture);
+    sec(SDL_RenderCopy(renderer, texture, srcrect, dstrect));
+}
+
+void render_copy_ex(SDL_Renderer *renderer, SDL_Texture *texture,
+                    const SDL_Rect *srcrect, const SDL_Rect *dstrect,
+                    SDL_RendererFlip flip)
+{
+    count_copy(texture);
+    sec(SDL_RenderCopyEx(renderer, texture, srcrect, dstrect, 0.0, nullptr, flip));
+}
+
 void render_line(SDL_Renderer *renderer, Vec2f begin, Vec2f end, RGBA color)
 {
-    SDL_Color sdl_color = rgba_to_sdl(color);
-    sec(SDL_SetRenderDrawColor(renderer, sdl_color.r, sdl_color.g, sdl_color.b, sdl_color.a));
-    sec(SDL_RenderDrawLine(
-            renderer,
-            (int) floorf(begin.x), (int) floorf(begin.y),
-            (int) floorf(end.x),   (int) floorf(end.y)));
+    render_draw_color(renderer, rgba_to_sdl(color));
+    render_draw_line(
+        renderer,
+        (int) floorf(begin.x), (int) floorf(begin.y),
+        (int) floorf(end.x),   (int) floorf(end.y));
 }
 
 void fill_rect(SDL_Renderer *renderer, Rectf rectf, RGBA color)
 {
-    SDL_Color sdl_color = rgba_to_sdl(color);
-    sec(SDL_SetRenderDrawColor(renderer, sdl_color.r, sdl_color.g, sdl_color.b, sdl_color.a));
+    render_draw_color(renderer, rgba_to_sdl(color));
     SDL_Rect rect = {
         (int) floorf(rectf.x),
         (int) floorf(rectf.y),
         (int) floorf(rectf.w),
         (int) floorf(rectf.h),
     };
-    sec(SDL_RenderFillRect(renderer, &rect));
+    render_fill_rect(renderer, &rect);
 }
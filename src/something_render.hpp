@@ -1,6 +1,108 @@
 #ifndef _SOMETHING_RENDER_HPP
 #define _SOMETHING_RENDER_HPP
 
+enum Render_Subsystem
+{
+    RENDER_SUBSYSTEM_OTHER = 0,
+    RENDER_SUBSYSTEM_BACKGROUND,
+    RENDER_SUBSYSTEM_TILES,
+    RENDER_SUBSYSTEM_ENTITIES,
+    RENDER_SUBSYSTEM_PARTICLES,
+    RENDER_SUBSYSTEM_UI,
+    RENDER_SUBSYSTEM_CONSOLE,
+    RENDER_SUBSYSTEMS_COUNT
+};
+
+const char *const render_subsystem_names[RENDER_SUBSYSTEMS_COUNT] = {
+    "other",
+    "background",
+    "tiles",
+    "entities",
+    "particles",
+    "ui",
+    "console",
+};
+
+const char *const RENDER_STATS_FILE_PATH = "./render_stats.csv";
+
+struct Render_Counters
+{
+    // NOTE: every call that submits something to the renderer
+    uint32_t draw_calls;
+    // NOTE: the draw color and the texture mods, plus every copy from a
+    // different texture than the previous one, which is what breaks the
+    // batches of the renderer
+    uint32_t state_changes;
+    // NOTE: the filled rects and the texture copies
+    uint32_t quads;
+
+    Render_Counters operator+(Render_Counters that) const
+    {
+        return {
+            draw_calls + that.draw_calls,
+            state_changes + that.state_changes,
+            quads + that.quads
+        };
+    }
+};
+
+// NOTE: all the rendering of the game goes through the render_*
+// wrappers below, which count the calls into the subsystem that is
+// current at the moment
+struct Render_Stats
+{
+    Render_Counters frame[RENDER_SUBSYSTEMS_COUNT];
+    // NOTE: the counters of the last finished frame, for the overlay
+    Render_Counters last[RENDER_SUBSYSTEMS_COUNT];
+    Render_Subsystem subsystem;
+    SDL_Texture *texture;
+
+    // NOTE: one line of CSV per frame while it is open
+    FILE *output;
+    uint64_t frames;
+
+    void begin_frame();
+    void end_frame();
+
+    Render_Counters last_total() const;
+
+    bool start_export(const char *filepath);
+    void stop_export();
+};
+
+extern Render_Stats render_stats;
+
+// NOTE: the nested scopes win, so the particles rendered by an entity
+// are counted as particles
+struct Render_Subsystem_Scope
+{
+    Render_Subsystem saved;
+
+    Render_Subsystem_Scope(Render_Subsystem subsystem)
+    {
+        saved = render_stats.subsystem;
+        render_stats.subsystem = subsystem;
+    }
+
+    ~Render_Subsystem_Scope()
+    {
+        render_stats.subsystem = saved;
+    }
+};
+
+void render_draw_color(SDL_Renderer *renderer, SDL_Color color);
+// NOTE: the color and the alpha mod of the texture
+void render_texture_mod(SDL_Texture *texture, SDL_Color color);
+void render_clear(SDL_Renderer *renderer);
+void render_fill_rect(SDL_Renderer *renderer, const SDL_Rect *rect);
+void render_draw_rect(SDL_Renderer *renderer, const SDL_Rect *rect);
+void render_draw_line(SDL_Renderer *renderer, int x1, int y1, int x2, int y2);
+void render_copy(SDL_Renderer *renderer, SDL_Texture *texture,
+                 const SDL_Rect *srcrect, const SDL_Rect *dstrect);
+void render_copy_ex(SDL_Renderer *renderer, SDL_Texture *texture,
+                    const SDL_Rect *srcrect, const SDL_Rect *dstrect,
+                    SDL_RendererFlip flip);
+
 void render_line(SDL_Renderer *renderer, Vec2f begin, Vec2f end, RGBA color);
 void fill_rect(SDL_Renderer *renderer, Rectf rect, RGBA color);
 
@@ -0,0 +1,186 @@
+#include "./something_replay.hpp"
+
+bool is_recordable_event(const SDL_Event *event)
+{
+    // NOTE: only the events Game::handle_event reacts to. The rest may
+    // carry pointers, and quitting is not a part of the session.
+    switch (event->type) {
+    case SDL_KEYDOWN:
+    case SDL_KEYUP:
+    case SDL_TEXTINPUT:
+    case SDL_MOUSEMOTION:
+    case SDL_MOUSEBUTTONDOWN:
+    case SDL_MOUSEBUTTONUP:
+    case SDL_MOUSEWHEEL:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool Input_Recorder::start(const char *filepath, uint32_t seed, uint32_t rooms_hash)
+{
+    file = fopen(filepath, "wb");
+    if (file == NULL) {
+        println(stderr, "Could not open file `", filepath, "`: ", strerror(errno));
+        return false;
+    }
+
+    Input_Recording_Header header = {};
+    header.magic = INPUT_RECORDING_MAGIC;
+    header.version = INPUT_RECORDING_VERSION;
+    header.seed = seed;
+    header.rooms_hash = rooms_hash;
+    header.event_size = sizeof(SDL_Event);
+    fwrite(&header, sizeof(header), 1, file);
+
+    ticks = 0;
+    memset(keyboard_bits, 0, sizeof(keyboard_bits));
+    return true;
+}
+
+void Input_Recorder::stop()
+{
+    if (file == NULL) return;
+
+    if (ferror(file)) {
+        println(stderr, "[ERROR] Could not write the input recording: ", strerror(errno));
+    }
+    fclose(file);
+    file = NULL;
+}
+
+void Input_Recorder::record_event(const SDL_Event *event)
+{
+    if (file == NULL || !is_recordable_event(event)) return;
+
+    const Input_Record_Kind kind = Input_Record_Kind::Event;
+    fwrite(&kind, sizeof(kind), 1, file);
+    fwrite(event, sizeof(*event), 1, file);
+}
+
+void Input_Recorder::record_tick(const Uint8 *keyboard)
+{
+    if (file == NULL) return;
+
+    uint8_t bits[INPUT_KEYBOARD_BITS_SIZE] = {};
+    for (size_t i = 0; i < SDL_NUM_SCANCODES; ++i) {
+        if (keyboard[i]) {
+            bits[i / 8] |= (uint8_t) (1 << (i % 8));
+        }
+    }
+
+    if (memcmp(bits, keyboard_bits, sizeof(bits)) != 0) {
+        memcpy(keyboard_bits, bits, sizeof(bits));
+        const Input_Record_Kind kind = Input_Record_Kind::Keyboard;
+        fwrite(&kind, sizeof(kind), 1, file);
+        fwrite(bits, sizeof(bits), 1, file);
+    }
+
+    const Input_Record_Kind kind = Input_Record_Kind::Tick;
+    fwrite(&kind, sizeof(kind), 1, file);
+    ticks += 1;
+}
+
+bool Input_Replayer::load(const char *filepath)
+{
+    unload();
+
+    FILE *f = fopen(filepath, "rb");
+    if (f == NULL) {
+        println(stderr, "Could not open file `", filepath, "`: ", strerror(errno));
+        return false;
+    }
+    defer(fclose(f));
+
+    fseek(f, 0, SEEK_END);
+    const long file_size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (file_size < 0) {
+        println(stderr, "Could not read file `", filepath, "`: ", strerror(errno));
+        return false;
+    }
+
+    data = (uint8_t*) malloc((size_t) file_size + 1);
+    assert(data != NULL);
+    size = (size_t) file_size;
+    if (fread(data, 1, size, f) != size) {
+        println(stderr, "Could not read file `", filepath, "`: ", strerror(errno));
+        unload();
+        return false;
+    }
+
+    Input_Recording_Header header = {};
+    if (size < sizeof(header)) {
+        println(stderr, filepath, ": the file is too small to be an input recording");
+        unload();
+        return false;
+    }
+    memcpy(&header, data, sizeof(header));
+
+    if (header.magic != INPUT_RECORDING_MAGIC) {
+        println(stderr, filepath, ": not an input recording");
+        unload();
+        return false;
+    }
+
+    if (header.version != INPUT_RECORDING_VERSION || header.event_size != sizeof(SDL_Event)) {
+        println(stderr, filepath, ": unsupported input recording version ", header.version,
+                " with events of ", header.event_size, " bytes. Expected ",
+                INPUT_RECORDING_VERSION, " with events of ", sizeof(SDL_Event), " bytes");
+        unload();
+        return false;
+    }
+
+    cursor = sizeof(header);
+    seed = header.seed;
+    rooms_hash = header.rooms_hash;
+    ticks = 0;
+    memset(keyboard, 0, sizeof(keyboard));
+    return true;
+}
+
+void Input_Replayer::unload()
+{
+    free(data);
+    data = NULL;
+    size = 0;
+    cursor = 0;
+}
+
+bool Input_Replayer::next_tick(Game *game)
+{
+    while (cursor < size) {
+        const Input_Record_Kind kind = (Input_Record_Kind) data[cursor++];
+
+        switch (kind) {
+        case Input_Record_Kind::Event: {
+            if (size - cursor < sizeof(SDL_Event)) break;
+
+            SDL_Event event = {};
+            memcpy(&event, data + cursor, sizeof(event));
+            cursor += sizeof(event);
+            game->handle_event(&event);
+        } continue;
+
+        case Input_Record_Kind::Keyboard: {
+            if (size - cursor < INPUT_KEYBOARD_BITS_SIZE) break;
+
+            for (size_t i = 0; i < SDL_NUM_SCANCODES; ++i) {
+                keyboard[i] = (data[cursor + i / 8] >> (i % 8)) & 1;
+            }
+            cursor += INPUT_KEYBOARD_BITS_SIZE;
+        } continue;
+
+        case Input_Record_Kind::Tick: {
+            ticks += 1;
+        } return true;
+        }
+
+        println(stderr, "[ERROR] The input recording is corrupted at byte ", cursor - 1,
+                " after ", ticks, " ticks");
+        cursor = size;
+    }
+
+    return false;
+}
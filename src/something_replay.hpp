@@ -0,0 +1,76 @@
+#ifndef SOMETHING_REPLAY_HPP_
+#define SOMETHING_REPLAY_HPP_
+
+const uint32_t INPUT_RECORDING_MAGIC = 0x43455253; // "SREC"
+const uint32_t INPUT_RECORDING_VERSION = 3;
+// NOTE: the recorded sessions start from a fresh world, so the rooms
+// saved by the normal runs must not leak into them
+const char *const INPUT_RECORDING_SAVE_DIR = "./saves/replay/";
+const size_t INPUT_KEYBOARD_BITS_SIZE = (SDL_NUM_SCANCODES + 7) / 8;
+
+struct Input_Recording_Header
+{
+    uint32_t magic;
+    uint32_t version;
+    // NOTE: Game::seed_rngs() seed of the recorded session
+    uint32_t seed;
+    // NOTE: hash_room_files() of the session. The world streamer picks
+    // the rooms by their index in that list.
+    uint32_t rooms_hash;
+    // NOTE: the events are stored as is, so a recording is only valid
+    // for the SDL version it was made with
+    uint32_t event_size;
+};
+
+enum class Input_Record_Kind: uint8_t
+{
+    // NOTE: followed by an SDL_Event that was passed to Game::handle_event
+    Event = 0,
+    // NOTE: followed by the bits of the keyboard state. Only recorded
+    // when it changes.
+    Keyboard,
+    // NOTE: one Game::update. Everything recorded before it was applied
+    // before that update.
+    Tick,
+};
+
+// NOTE: records everything Game reads from SDL between the simulation
+// ticks. The game is deterministic for the same seed, the same build,
+// the same assets and the same config, so replaying the recording
+// reproduces the session bit for bit. Hot reloading anything or
+// quickloading while recording breaks that.
+struct Input_Recorder
+{
+    FILE *file;
+    uint64_t ticks;
+    uint8_t keyboard_bits[INPUT_KEYBOARD_BITS_SIZE];
+
+    bool start(const char *filepath, uint32_t seed, uint32_t rooms_hash);
+    void stop();
+
+    void record_event(const SDL_Event *event);
+    // NOTE: right before Game::update
+    void record_tick(const Uint8 *keyboard);
+};
+
+struct Input_Replayer
+{
+    uint8_t *data;
+    size_t size;
+    size_t cursor;
+    uint32_t seed;
+    uint32_t rooms_hash;
+    uint64_t ticks;
+    Uint8 keyboard[SDL_NUM_SCANCODES];
+
+    bool load(const char *filepath);
+    void unload();
+
+    // NOTE: feeds the events and the keyboard state of the next tick to
+    // the game. Returns false when the recording is over.
+    bool next_tick(Game *game);
+};
+
+bool is_recordable_event(const SDL_Event *event);
+
+#endif  // SOMETHING_REPLAY_HPP_
@@ -0,0 +1,396 @@
+#include "./something_snapshot.hpp"
+
+struct Game_Snapshot_Header
+{
+    uint32_t magic;
+    uint32_t version;
+    // NOTE: the arrays of these are copied as is, the sizes catch the
+    // snapshots made by a different build
+    uint32_t entity_size;
+    uint32_t projectile_size;
+    uint32_t playback_size;
+    uint32_t item_size;
+    // NOTE: the rooms that are not in the snapshot stream in from the
+    // world of this seed
+    uint32_t world_seed;
+    uint32_t rooms_count;
+    uint32_t loose_tiles_count;
+};
+
+enum class Snapshot_Room_Kind: uint8_t
+{
+    Template = 0,
+    Delta,
+};
+
+struct Snapshot_Room
+{
+    Vec2i slot;
+    Snapshot_Room_Kind kind;
+    Room_Template_Index template_index;
+    Tile tiles[ROOM_HEIGHT][ROOM_WIDTH];
+};
+
+struct Snapshot_Loose_Tile
+{
+    Vec2i coord;
+    Tile tile;
+};
+
+struct Snapshot_Writer
+{
+    Game_Snapshot *snapshot;
+    bool overflow;
+
+    void write(const void *data, size_t size)
+    {
+        if (overflow || snapshot->size + size > GAME_SNAPSHOT_CAPACITY) {
+            overflow = true;
+            return;
+        }
+        memcpy(snapshot->bytes + snapshot->size, data, size);
+        snapshot->size += size;
+    }
+
+    void write_varint(uint32_t x)
+    {
+        uint8_t bytes[5];
+        write(bytes, world_put_varint(bytes, x));
+    }
+};
+
+struct Snapshot_Reader
+{
+    const uint8_t *p;
+    const uint8_t *end;
+    bool ok;
+
+    // NOTE: returns where the data is in the snapshot, so the big arrays
+    // are copied only once the whole snapshot is validated
+    const uint8_t *read(void *data, size_t size)
+    {
+        if (!ok || (size_t) (end - p) < size) {
+            ok = false;
+            return NULL;
+        }
+        const uint8_t *result = p;
+        if (data) memcpy(data, p, size);
+        p += size;
+        return result;
+    }
+
+    uint32_t read_varint()
+    {
+        uint32_t x = 0;
+        if (ok && !world_get_varint(&p, end, &x)) ok = false;
+        return x;
+    }
+};
+
+static bool is_in_loaded_room(World_Streamer *streamer, Vec2i coord)
+{
+    const Vec2i slot = room_layout_slot(coord);
+    if (!is_room_slot_inbounds(slot)) return false;
+    const Vec2i local = coord - room_layout_coord(slot);
+    return local.x < ROOM_WIDTH && local.y < ROOM_HEIGHT &&
+        streamer->slots[slot.y][slot.x] == Room_Slot_State::Loaded;
+}
+
+// NOTE: the tiles of the loaded rooms and of the gaps around them.
+// `end` is exclusive.
+static bool loaded_rooms_bounds(World_Streamer *streamer, Vec2i *begin, Vec2i *end)
+{
+    bool found = false;
+    for (size_t i = 0; i < streamer->active_count; ++i) {
+        const Vec2i slot = streamer->active[i];
+        if (streamer->slots[slot.y][slot.x] != Room_Slot_State::Loaded) continue;
+
+        const Vec2i coord = room_layout_coord(slot);
+        const Vec2i room_begin = coord - ROOM_LAYOUT_PADDING;
+        const Vec2i room_end = coord + vec2(ROOM_WIDTH, ROOM_HEIGHT) + ROOM_LAYOUT_PADDING;
+        if (!found) {
+            *begin = room_begin;
+            *end = room_end;
+            found = true;
+        } else {
+            *begin = vec2(min(begin->x, room_begin.x), min(begin->y, room_begin.y));
+            *end = vec2(max(end->x, room_end.x), max(end->y, room_end.y));
+        }
+    }
+
+    if (found) {
+        *begin = vec2(max(begin->x, 0), max(begin->y, 0));
+        *end = vec2(min(end->x, (int) TILE_GRID_WIDTH), min(end->y, (int) TILE_GRID_HEIGHT));
+    }
+
+    return found;
+}
+
+bool save_game_snapshot(Game *game, World_Streamer *streamer, Game_Snapshot *snapshot)
+{
+    snapshot->size = 0;
+    Snapshot_Writer writer = {snapshot, false};
+
+    Game_Snapshot_Header header = {};
+    header.magic = GAME_SNAPSHOT_MAGIC;
+    header.version = GAME_SNAPSHOT_VERSION;
+    header.entity_size = sizeof(Entity);
+    header.projectile_size = sizeof(Projectile);
+    header.playback_size = sizeof(Frame_Animat_Playback);
+    header.item_size = sizeof(Item);
+    header.world_seed = streamer->seed;
+    for (size_t i = 0; i < streamer->active_count; ++i) {
+        const Vec2i slot = streamer->active[i];
+        if (streamer->slots[slot.y][slot.x] == Room_Slot_State::Loaded) {
+            header.rooms_count += 1;
+        }
+    }
+
+    static Snapshot_Loose_Tile loose_tiles[GAME_SNAPSHOT_LOOSE_TILES_CAPACITY];
+    Vec2i begin = {};
+    Vec2i end = {};
+    if (loaded_rooms_bounds(streamer, &begin, &end)) {
+        for (int y = begin.y; y < end.y; ++y) {
+            for (int x = begin.x; x < end.x; ++x) {
+                const Vec2i coord = vec2(x, y);
+                if (is_in_loaded_room(streamer, coord)) continue;
+
+                const Tile tile = game->grid.get_tile(coord);
+                if (tile == TILE_EMPTY) continue;
+
+                if (header.loose_tiles_count >= GAME_SNAPSHOT_LOOSE_TILES_CAPACITY) {
+                    return false;
+                }
+                loose_tiles[header.loose_tiles_count++] = {coord, tile};
+            }
+        }
+    }
+
+    writer.write(&header, sizeof(header));
+    writer.write(game->entities, sizeof(game->entities));
+    writer.write(game->projectiles, sizeof(game->projectiles));
+    writer.write(game->animat_playbacks, sizeof(game->animat_playbacks));
+    writer.write(game->items, sizeof(game->items));
+    writer.write(&game->camera, sizeof(game->camera));
+    writer.write(&game->collision_probe, sizeof(game->collision_probe));
+    writer.write(&game->tracking_projectile, sizeof(game->tracking_projectile));
+    writer.write(game->rngs, sizeof(game->rngs));
+    writer.write(&game->camera_locks_count, sizeof(game->camera_locks_count));
+    writer.write(game->camera_locks, sizeof(game->camera_locks[0]) * game->camera_locks_count);
+
+    for (size_t i = 0; i < streamer->active_count; ++i) {
+        const Vec2i slot = streamer->active[i];
+        if (streamer->slots[slot.y][slot.x] != Room_Slot_State::Loaded) continue;
+
+        const Vec2i coord = room_layout_coord(slot);
+        const Room_Ref *ref = game->grid.room_ref_at(coord);
+        const bool untouched = ref && ref->coord.x == coord.x && ref->coord.y == coord.y;
+        const Snapshot_Room_Kind kind = untouched ? Snapshot_Room_Kind::Template : Snapshot_Room_Kind::Delta;
+        const Room_Template_Index template_index =
+            untouched ? ref->template_index : streamer->template_of_slot(slot);
+        const uint32_t template_unwrap = (uint32_t) template_index.unwrap;
+
+        writer.write(&slot, sizeof(slot));
+        writer.write(&kind, sizeof(kind));
+        writer.write(&template_unwrap, sizeof(template_unwrap));
+        if (untouched) continue;
+
+        // NOTE: runs of (length, tile ^ template tile). The tiles that
+        // match the template are long runs of zeros.
+        const auto &templ = game->grid.room_templates[template_index.unwrap];
+        const size_t n = ROOM_WIDTH * ROOM_HEIGHT;
+        size_t j = 0;
+        while (j < n) {
+            const int dx = (int) (j % ROOM_WIDTH);
+            const int dy = (int) (j / ROOM_WIDTH);
+            const Tile delta = game->grid.get_tile(coord + vec2(dx, dy)) ^ templ.tiles[dy][dx];
+            size_t length = 1;
+            while (j + length < n) {
+                const int dx1 = (int) ((j + length) % ROOM_WIDTH);
+                const int dy1 = (int) ((j + length) / ROOM_WIDTH);
+                if ((game->grid.get_tile(coord + vec2(dx1, dy1)) ^ templ.tiles[dy1][dx1]) != delta) break;
+                length += 1;
+            }
+            writer.write_varint((uint32_t) length);
+            writer.write_varint(delta);
+            j += length;
+        }
+    }
+
+    writer.write(loose_tiles, sizeof(loose_tiles[0]) * header.loose_tiles_count);
+
+    return !writer.overflow;
+}
+
+bool restore_game_snapshot(Game *game, World_Streamer *streamer, const Game_Snapshot *snapshot)
+{
+    static Snapshot_Room rooms[WORLD_STREAMER_ACTIVE_CAPACITY];
+    static Snapshot_Loose_Tile loose_tiles[GAME_SNAPSHOT_LOOSE_TILES_CAPACITY];
+
+    //// VALIDATE //////////////////////////////
+    Snapshot_Reader reader = {snapshot->bytes, snapshot->bytes + snapshot->size, true};
+
+    Game_Snapshot_Header header = {};
+    reader.read(&header, sizeof(header));
+    if (!reader.ok ||
+        header.magic != GAME_SNAPSHOT_MAGIC ||
+        header.version != GAME_SNAPSHOT_VERSION ||
+        header.entity_size != sizeof(Entity) ||
+        header.projectile_size != sizeof(Projectile) ||
+        header.playback_size != sizeof(Frame_Animat_Playback) ||
+        header.item_size != sizeof(Item) ||
+        header.world_seed != streamer->seed ||
+        header.rooms_count > WORLD_STREAMER_ACTIVE_CAPACITY ||
+        header.loose_tiles_count > GAME_SNAPSHOT_LOOSE_TILES_CAPACITY)
+    {
+        return false;
+    }
+
+    const uint8_t *entities = reader.read(NULL, sizeof(game->entities));
+    const uint8_t *projectiles = reader.read(NULL, sizeof(game->projectiles));
+    const uint8_t *animat_playbacks = reader.read(NULL, sizeof(game->animat_playbacks));
+    const uint8_t *items = reader.read(NULL, sizeof(game->items));
+    Camera camera = {};
+    reader.read(&camera, sizeof(camera));
+    Vec2f collision_probe = {};
+    reader.read(&collision_probe, sizeof(collision_probe));
+    Maybe<Projectile_Index> tracking_projectile = {};
+    reader.read(&tracking_projectile, sizeof(tracking_projectile));
+    Rng rngs[RNG_STREAMS_COUNT] = {};
+    reader.read(rngs, sizeof(rngs));
+    size_t camera_locks_count = 0;
+    reader.read(&camera_locks_count, sizeof(camera_locks_count));
+    if (camera_locks_count > CAMERA_LOCKS_CAPACITY) return false;
+    const uint8_t *camera_locks = reader.read(NULL, sizeof(game->camera_locks[0]) * camera_locks_count);
+
+    for (size_t i = 0; i < header.rooms_count; ++i) {
+        Snapshot_Room *room = &rooms[i];
+        uint32_t template_unwrap = 0;
+        reader.read(&room->slot, sizeof(room->slot));
+        reader.read(&room->kind, sizeof(room->kind));
+        reader.read(&template_unwrap, sizeof(template_unwrap));
+        room->template_index = {template_unwrap};
+        if (!reader.ok ||
+            !is_room_slot_inbounds(room->slot) ||
+            template_unwrap >= game->grid.room_templates_count)
+        {
+            return false;
+        }
+
+        switch (room->kind) {
+        case Snapshot_Room_Kind::Template:
+            break;
+
+        case Snapshot_Room_Kind::Delta: {
+            const auto &templ = game->grid.room_templates[template_unwrap];
+            const size_t n = ROOM_WIDTH * ROOM_HEIGHT;
+            size_t j = 0;
+            while (j < n) {
+                const uint32_t length = reader.read_varint();
+                const uint32_t delta = reader.read_varint();
+                if (!reader.ok || length == 0 || length > n - j) return false;
+
+                for (uint32_t k = 0; k < length; ++k, ++j) {
+                    const size_t dx = j % ROOM_WIDTH;
+                    const size_t dy = j / ROOM_WIDTH;
+                    room->tiles[dy][dx] = templ.tiles[dy][dx] ^ delta;
+                    if (room->tiles[dy][dx] >= TILE_COUNT) return false;
+                }
+            }
+        } break;
+
+        default:
+            return false;
+        }
+    }
+
+    reader.read(loose_tiles, sizeof(loose_tiles[0]) * header.loose_tiles_count);
+    if (!reader.ok || reader.p != reader.end) return false;
+
+    //// APPLY //////////////////////////////
+    // NOTE: everything the streamer has loaded goes away without being
+    // saved. The loads that are still in flight are dropped by
+    // World_Streamer::apply_results, because their slots are not
+    // Loading anymore.
+    Vec2i begin = {};
+    Vec2i end = {};
+    if (loaded_rooms_bounds(streamer, &begin, &end)) {
+        for (int y = begin.y; y < end.y; ++y) {
+            for (int x = begin.x; x < end.x; ++x) {
+                if (!is_in_loaded_room(streamer, vec2(x, y))) {
+                    game->grid.set_tile(vec2(x, y), TILE_EMPTY);
+                }
+            }
+        }
+    }
+
+    static Tile discarded[ROOM_HEIGHT][ROOM_WIDTH];
+    for (size_t i = 0; i < streamer->active_count; ++i) {
+        const Vec2i slot = streamer->active[i];
+        if (streamer->slots[slot.y][slot.x] == Room_Slot_State::Loaded) {
+            game->grid.evict_room(room_layout_coord(slot), discarded);
+        }
+        streamer->slots[slot.y][slot.x] = Room_Slot_State::Unloaded;
+    }
+    streamer->active_count = 0;
+
+    for (size_t i = 0; i < header.rooms_count; ++i) {
+        const Snapshot_Room *room = &rooms[i];
+        const Vec2i coord = room_layout_coord(room->slot);
+        switch (room->kind) {
+        case Snapshot_Room_Kind::Template: {
+            game->grid.instance_room(room->template_index, coord);
+        } break;
+
+        case Snapshot_Room_Kind::Delta: {
+            for (int dy = 0; dy < ROOM_HEIGHT; ++dy) {
+                for (int dx = 0; dx < ROOM_WIDTH; ++dx) {
+                    game->grid.set_tile(coord + vec2(dx, dy), room->tiles[dy][dx]);
+                }
+            }
+        } break;
+        }
+
+        streamer->slots[room->slot.y][room->slot.x] = Room_Slot_State::Loaded;
+        streamer->active[streamer->active_count++] = room->slot;
+    }
+
+    for (size_t i = 0; i < header.loose_tiles_count; ++i) {
+        game->grid.set_tile(loose_tiles[i].coord, loose_tiles[i].tile);
+    }
+
+    memcpy(game->entities, entities, sizeof(game->entities));
+    memcpy(game->projectiles, projectiles, sizeof(game->projectiles));
+    memcpy(game->animat_playbacks, animat_playbacks, sizeof(game->animat_playbacks));
+    memcpy(game->items, items, sizeof(game->items));
+    game->camera = camera;
+    game->collision_probe = collision_probe;
+    game->tracking_projectile = tracking_projectile;
+    memcpy(game->rngs, rngs, sizeof(game->rngs));
+    game->camera_locks_count = camera_locks_count;
+    memcpy(game->camera_locks, camera_locks, sizeof(game->camera_locks[0]) * camera_locks_count);
+
+    return true;
+}
+
+int save_game_snapshot_to_file(const char *filepath, const Game_Snapshot *snapshot)
+{
+    FILE *f = fopen(filepath, "wb");
+    if (f == NULL) return errno;
+    defer(fclose(f));
+
+    fwrite(snapshot->bytes, 1, snapshot->size, f);
+    if (ferror(f)) return errno ? errno : EIO;
+    return 0;
+}
+
+int load_game_snapshot_from_file(const char *filepath, Game_Snapshot *snapshot)
+{
+    FILE *f = fopen(filepath, "rb");
+    if (f == NULL) return errno;
+    defer(fclose(f));
+
+    snapshot->size = fread(snapshot->bytes, 1, GAME_SNAPSHOT_CAPACITY, f);
+    if (ferror(f)) return errno ? errno : EIO;
+    return 0;
+}
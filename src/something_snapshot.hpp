@@ -0,0 +1,37 @@
+#ifndef SOMETHING_SNAPSHOT_HPP_
+#define SOMETHING_SNAPSHOT_HPP_
+
+const uint32_t GAME_SNAPSHOT_MAGIC = 0x504e5353; // "SSNP"
+const uint32_t GAME_SNAPSHOT_VERSION = 3;
+const size_t GAME_SNAPSHOT_CAPACITY = 8 * 1024 * 1024;
+// NOTE: the tiles outside of the loaded rooms, like the blocks placed
+// in the gaps between them
+const size_t GAME_SNAPSHOT_LOOSE_TILES_CAPACITY = 4096;
+const char *const QUICKSAVE_FILE_PATH = "./saves/quicksave.bin";
+
+// NOTE: the simulation part of Game and the loaded part of the world.
+// Everything that is not simulation (the mixer, the console, the
+// popups, the debug toolbar, the fonts) stays as it is on restore.
+//
+// The entities, the projectiles, the items and the animation playbacks
+// are plain arrays and are copied as is, so a snapshot is only valid
+// for the build that made it. The rooms are stored as a delta against
+// their templates, so the untouched ones take a few bytes.
+//
+// The rooms that were evicted and saved to the streamer save_dir
+// after the snapshot was taken are not rolled back.
+struct Game_Snapshot
+{
+    uint8_t bytes[GAME_SNAPSHOT_CAPACITY];
+    size_t size;
+};
+
+bool save_game_snapshot(Game *game, World_Streamer *streamer, Game_Snapshot *snapshot);
+// NOTE: validates the whole snapshot first and leaves the game untouched
+// if it is corrupted or was made by a different build
+bool restore_game_snapshot(Game *game, World_Streamer *streamer, const Game_Snapshot *snapshot);
+
+int save_game_snapshot_to_file(const char *filepath, const Game_Snapshot *snapshot);
+int load_game_snapshot_from_file(const char *filepath, Game_Snapshot *snapshot);
+
+#endif  // SOMETHING_SNAPSHOT_HPP_
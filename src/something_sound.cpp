@@ -1,26 +1,529 @@
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#include <sys/stat.h>
+
 #include "./something_sound.hpp"
 
-void Sample_Mixer::clean()
+bool Mixer_Command_Queue::push(Mixer_Command command)
 {
-    for (size_t i = 0; i < SAMPLE_MIXER_CAPACITY; ++i) {
-        samples[i] = {};
+    static_assert((MIXER_COMMANDS_CAPACITY & (MIXER_COMMANDS_CAPACITY - 1)) == 0);
+
+    // NOTE: SDL_AtomicSet is only an acquire barrier on some compilers,
+    // so the writes of the item are released explicitly before the
+    // index that publishes them, and the index of the other side is
+    // acquired before the items behind it are touched
+    const int e = SDL_AtomicGet(&end);
+    const int next = (e + 1) & (int) (MIXER_COMMANDS_CAPACITY - 1);
+    if (next == SDL_AtomicGet(&begin)) {
+        return false;
+    }
+    SDL_MemoryBarrierAcquire();
+
+    items[e] = command;
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&end, next);
+    return true;
+}
+
+bool Mixer_Command_Queue::pop(Mixer_Command *command)
+{
+    const int b = SDL_AtomicGet(&begin);
+    if (b == SDL_AtomicGet(&end)) {
+        return false;
+    }
+    SDL_MemoryBarrierAcquire();
+
+    *command = items[b];
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&begin, (b + 1) & (int) (MIXER_COMMANDS_CAPACITY - 1));
+    return true;
+}
+
+bool Mixer_Command_Queue::empty()
+{
+    return SDL_AtomicGet(&begin) == SDL_AtomicGet(&end);
+}
+
+static Uint32 read_u32_le(const Uint8 *bytes)
+{
+    return (Uint32) bytes[0]
+        | ((Uint32) bytes[1] << 8)
+        | ((Uint32) bytes[2] << 16)
+        | ((Uint32) bytes[3] << 24);
+}
+
+static Uint16 read_u16_le(const Uint8 *bytes)
+{
+    return (Uint16) (bytes[0] | (bytes[1] << 8));
+}
+
+static int sample_stream_thread(void *data)
+{
+    Sample_Stream *stream = (Sample_Stream *) data;
+    while (!SDL_AtomicGet(&stream->quit)) {
+        if (!stream->fill()) {
+            SDL_Delay(SAMPLE_STREAM_IDLE_MS);
+        }
+    }
+    return 0;
+}
+
+bool Sample_Stream::open(const char *file_path, bool loop)
+{
+    assert(file == NULL);
+
+    file = fopen(file_path, "rb");
+    if (file == NULL) {
+        println(stderr, "[ERROR] Could not open ", file_path, ": ", strerror(errno));
+        return false;
+    }
+
+    Uint8 header[12];
+    if (fread(header, 1, sizeof(header), file) != sizeof(header) ||
+        memcmp(header, "RIFF", 4) != 0 ||
+        memcmp(header + 8, "WAVE", 4) != 0)
+    {
+        println(stderr, "[ERROR] ", file_path, " is not a WAV file");
+        fclose(file);
+        file = NULL;
+        return false;
+    }
+
+    bool has_fmt = false;
+    for (;;) {
+        Uint8 chunk[8];
+        if (fread(chunk, 1, sizeof(chunk), file) != sizeof(chunk)) {
+            println(stderr, "[ERROR] ", file_path, " has no data chunk");
+            fclose(file);
+            file = NULL;
+            return false;
+        }
+        const Uint32 chunk_size = read_u32_le(chunk + 4);
+
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            Uint8 fmt[16];
+            if (chunk_size < sizeof(fmt) || fread(fmt, 1, sizeof(fmt), file) != sizeof(fmt)) {
+                println(stderr, "[ERROR] ", file_path, " has a broken fmt chunk");
+                fclose(file);
+                file = NULL;
+                return false;
+            }
+
+            const Uint16 format = read_u16_le(fmt);
+            channels = read_u16_le(fmt + 2);
+            const Uint32 freq = read_u32_le(fmt + 4);
+            const Uint16 bits = read_u16_le(fmt + 14);
+            if (format != 1 || bits != 16 || freq != SOMETHING_SOUND_FREQ ||
+                channels < 1 || channels > SOMETHING_SOUND_CHANNELS)
+            {
+                println(stderr, "[ERROR] ", file_path, " must be 16-bit PCM, ",
+                        SOMETHING_SOUND_FREQ, " Hz, mono or stereo to be streamed");
+                fclose(file);
+                file = NULL;
+                return false;
+            }
+
+            fseek(file, (long) (chunk_size - sizeof(fmt) + (chunk_size & 1)), SEEK_CUR);
+            has_fmt = true;
+        } else if (memcmp(chunk, "data", 4) == 0 && has_fmt) {
+            data_begin = ftell(file);
+            data_size = chunk_size;
+            break;
+        } else {
+            fseek(file, (long) (chunk_size + (chunk_size & 1)), SEEK_CUR);
+        }
+    }
+
+    data_read = 0;
+    looping = loop;
+    SDL_AtomicSet(&begin, 0);
+    SDL_AtomicSet(&end, 0);
+    SDL_AtomicSet(&finished, 0);
+    SDL_AtomicSet(&underruns, 0);
+    SDL_AtomicSet(&quit, 0);
+
+    // NOTE: prefilling the ring so the music doesn't start with an
+    // underrun
+    while (fill()) {}
+
+    thread = SDL_CreateThread(sample_stream_thread, "Sample_Stream", this);
+    if (thread == NULL) {
+        println(stderr, "SDL pooped itself: Failed to create a thread: ", SDL_GetError());
+        abort();
+    }
+
+    return true;
+}
+
+void Sample_Stream::close()
+{
+    if (file == NULL) return;
+
+    SDL_AtomicSet(&quit, 1);
+    SDL_WaitThread(thread, NULL);
+    thread = NULL;
+
+    fclose(file);
+    file = NULL;
+}
+
+// NOTE: reads at most one chunk into the ring. Returns false when there
+// was nothing to do, so the reader thread can take a nap.
+bool Sample_Stream::fill()
+{
+    static_assert((SAMPLE_STREAM_CAPACITY & (SAMPLE_STREAM_CAPACITY - 1)) == 0);
+
+    if (SDL_AtomicGet(&finished)) return false;
+
+    // NOTE: the same barriers as in Mixer_Command_Queue. The samples
+    // are released before `end` publishes them and the audio thread is
+    // done with the ring up to `begin` before it is overwritten.
+    const size_t b = (size_t) SDL_AtomicGet(&begin);
+    const size_t e = (size_t) SDL_AtomicGet(&end);
+    SDL_MemoryBarrierAcquire();
+    const size_t used = (e - b) & (SAMPLE_STREAM_CAPACITY - 1);
+    const size_t space = SAMPLE_STREAM_CAPACITY - 1 - used;
+
+    // NOTE: writing only whole frames so the audio callback never sees
+    // half of a stereo frame at the edge of the ring
+    if (space < SAMPLE_STREAM_CHUNK) return false;
+
+    size_t count = min(SAMPLE_STREAM_CAPACITY - e, SAMPLE_STREAM_CHUNK);
+    count -= count % channels;
+    if (count == 0) return false;
+
+    const size_t frame_size = channels * sizeof(ring[0]);
+    size_t bytes = min(count * sizeof(ring[0]), (size_t) (data_size - data_read));
+    bytes -= bytes % frame_size;
+
+    const size_t n = fread(ring + e, 1, bytes, file) / frame_size * frame_size;
+    if (n == 0) {
+        if (looping && data_size >= frame_size) {
+            fseek(file, data_begin, SEEK_SET);
+            data_read = 0;
+        } else {
+            SDL_AtomicSet(&finished, 1);
+        }
+        return true;
+    }
+
+    data_read += (Uint32) n;
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&end, (int) ((e + n / sizeof(ring[0])) & (SAMPLE_STREAM_CAPACITY - 1)));
+    return true;
+}
+
+// NOTE: the biggest contiguous span of the ring that is ready to be
+// mixed
+const int16_t *Sample_Stream::peek(size_t *count)
+{
+    const size_t b = (size_t) SDL_AtomicGet(&begin);
+    const size_t e = (size_t) SDL_AtomicGet(&end);
+    SDL_MemoryBarrierAcquire();
+    *count = e >= b ? e - b : SAMPLE_STREAM_CAPACITY - b;
+    return ring + b;
+}
+
+void Sample_Stream::consume(size_t count)
+{
+    const size_t b = (size_t) SDL_AtomicGet(&begin);
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&begin, (int) ((b + count) & (SAMPLE_STREAM_CAPACITY - 1)));
+}
+
+void Sample_Mixer::play_sample(Sample_S16 sample, Sound_Params params)
+{
+    Mixer_Command command = {};
+    command.type = Mixer_Command_Type::Play;
+    command.voice.sample = sample;
+    command.voice.sample.audio_cur = 0;
+    command.voice.gain_left = params.gain;
+    command.voice.gain_right = params.gain;
+    command.voice.priority = params.priority;
+    command.max_instances = params.max_instances;
+    // NOTE: if the audio thread is too far behind the sound is
+    // dropped, the same way it is dropped when there is no voice it
+    // is allowed to steal.
+    if (!commands.push(command)) {
+        SDL_AtomicAdd(&stats.dropped, 1);
+    }
+}
+
+// NOTE: the gain falls off linearly from SOUND_ATTENUATION_MIN_DISTANCE
+// to SOUND_ATTENUATION_MAX_DISTANCE and the pan follows the horizontal
+// offset from the listener. The sounds that would end up quieter than
+// SOUND_CULL_GAIN are never sent to the audio thread, so they don't
+// occupy a voice.
+void Sample_Mixer::play_sample_at(Sample_S16 sample, Sound_Params params, Vec2f pos)
+{
+    const Vec2f d = pos - listener;
+    const float distance = sqrtf(d.x * d.x + d.y * d.y);
+    const float attenuation = 1.0f - clamp(
+        (distance - SOUND_ATTENUATION_MIN_DISTANCE) /
+        (SOUND_ATTENUATION_MAX_DISTANCE - SOUND_ATTENUATION_MIN_DISTANCE),
+        0.0f, 1.0f);
+    const float gain = params.gain * attenuation;
+    if (gain < SOUND_CULL_GAIN) {
+        SDL_AtomicAdd(&stats.culled, 1);
+        return;
+    }
+
+    const float pan = clamp(d.x / SOUND_PAN_DISTANCE, -1.0f, 1.0f);
+
+    Mixer_Command command = {};
+    command.type = Mixer_Command_Type::Play;
+    command.voice.sample = sample;
+    command.voice.sample.audio_cur = 0;
+    command.voice.gain_left = gain * min(1.0f, 1.0f - pan);
+    command.voice.gain_right = gain * min(1.0f, 1.0f + pan);
+    command.voice.priority = params.priority;
+    command.max_instances = params.max_instances;
+    if (!commands.push(command)) {
+        SDL_AtomicAdd(&stats.dropped, 1);
+    }
+}
+
+// NOTE: for the commands that must not be dropped. Waits for the
+// audio thread to make room in the queue.
+void Sample_Mixer::push_waiting(Mixer_Command command)
+{
+    while (!commands.push(command)) {
+        if (no_device) {
+            process_commands();
+        } else {
+            SDL_Delay(1);
+        }
     }
 }
 
-void Sample_Mixer::play_sample(Sample_S16 sample)
+void Sample_Mixer::stop_all()
+{
+    Mixer_Command command = {};
+    command.type = Mixer_Command_Type::Stop_All;
+    push_waiting(command);
+}
+
+void Sample_Mixer::set_volume(float new_volume)
 {
+    Mixer_Command command = {};
+    command.type = Mixer_Command_Type::Set_Volume;
+    command.volume = new_volume;
+    push_waiting(command);
+}
+
+bool Sample_Mixer::play_music(const char *file_path, float gain)
+{
+    stop_music();
+
+    if (!music.open(file_path, true)) {
+        return false;
+    }
+
+    Mixer_Command command = {};
+    command.type = Mixer_Command_Type::Play_Music;
+    command.volume = gain;
+    push_waiting(command);
+    return true;
+}
+
+// NOTE: the audio thread must let go of the ring before the reader
+// thread is stopped, hence the sync()
+void Sample_Mixer::stop_music()
+{
+    if (music.file == NULL) return;
+
+    Mixer_Command command = {};
+    command.type = Mixer_Command_Type::Stop_Music;
+    push_waiting(command);
+    sync();
+    music.close();
+}
+
+// NOTE: blocks until the audio thread consumed every command pushed
+// so far. After stop_all() + sync() no voice refers to any sample
+// anymore, so the samples can be safely freed (see F6 in main).
+void Sample_Mixer::sync()
+{
+    if (no_device) {
+        process_commands();
+        return;
+    }
+
+    while (!commands.empty()) {
+        SDL_Delay(1);
+    }
+}
+
+// NOTE: picks the voice for a new sound in the following order:
+//   1. if the sample already plays max_instances times, the oldest of
+//      those instances is restarted as the new one;
+//   2. any free voice;
+//   3. the voice with the lowest priority, then the quietest, then the
+//      oldest one, as long as its priority is not higher than the new
+//      sound's.
+// Returns NULL when the sound should be dropped.
+Mixer_Voice *Sample_Mixer::allocate_voice(Mixer_Voice voice, int max_instances)
+{
+    Mixer_Voice *oldest_instance = NULL;
+    int instances = 0;
+    Mixer_Voice *free_voice = NULL;
+    Mixer_Voice *victim = NULL;
+
     for (size_t i = 0; i < SAMPLE_MIXER_CAPACITY; ++i) {
-        if (samples[i].audio_cur >= samples[i].audio_len) {
-            samples[i] = sample;
-            samples[i].audio_cur = 0;
-            return;
+        Mixer_Voice *it = &voices[i];
+
+        if (!it->active()) {
+            if (free_voice == NULL) free_voice = it;
+            continue;
+        }
+
+        if (it->sample.audio_buf == voice.sample.audio_buf) {
+            instances += 1;
+            if (oldest_instance == NULL || it->started < oldest_instance->started) {
+                oldest_instance = it;
+            }
         }
+
+        if (victim == NULL ||
+            it->priority < victim->priority ||
+            (it->priority == victim->priority &&
+             (it->loudness() < victim->loudness() ||
+              (it->loudness() == victim->loudness() && it->started < victim->started))))
+        {
+            victim = it;
+        }
+    }
+
+    if (max_instances > 0 && instances >= max_instances) {
+        return oldest_instance;
+    }
+
+    if (free_voice != NULL) {
+        return free_voice;
+    }
+
+    if (victim != NULL && victim->priority <= voice.priority) {
+        return victim;
+    }
+
+    return NULL;
+}
+
+void Sample_Mixer::process_commands()
+{
+    Mixer_Command command = {};
+    while (commands.pop(&command)) {
+        switch (command.type) {
+        case Mixer_Command_Type::Play: {
+            Mixer_Voice *voice = allocate_voice(command.voice, command.max_instances);
+            if (voice != NULL) {
+                *voice = command.voice;
+                voice->started = voices_started++;
+            } else {
+                SDL_AtomicAdd(&stats.dropped, 1);
+            }
+        } break;
+
+        case Mixer_Command_Type::Stop_All: {
+            for (size_t i = 0; i < SAMPLE_MIXER_CAPACITY; ++i) {
+                voices[i] = {};
+            }
+        } break;
+
+        case Mixer_Command_Type::Set_Volume: {
+            volume = command.volume;
+        } break;
+
+        case Mixer_Command_Type::Play_Music: {
+            music_playing = true;
+            music_gain = command.volume;
+        } break;
+
+        case Mixer_Command_Type::Stop_Music: {
+            music_playing = false;
+        } break;
+        }
+    }
+}
+
+bool load_sample_cache(const char *cache_path, Sample_Cache_Header expected, Sample_S16 *sample)
+{
+    FILE *f = fopen(cache_path, "rb");
+    if (f == NULL) return false;
+    defer(fclose(f));
+
+    Sample_Cache_Header header = {};
+    if (fread(&header, sizeof(header), 1, f) != 1 ||
+        header.magic != expected.magic ||
+        header.version != expected.version ||
+        header.source_size != expected.source_size ||
+        header.source_mtime != expected.source_mtime ||
+        header.freq != expected.freq ||
+        header.channels != expected.channels)
+    {
+        return false;
+    }
+
+    int16_t *audio_buf = (int16_t*) SDL_malloc(header.audio_len * sizeof(int16_t));
+    assert(audio_buf != NULL);
+    if (fread(audio_buf, sizeof(int16_t), header.audio_len, f) != header.audio_len) {
+        SDL_free(audio_buf);
+        return false;
+    }
+
+    sample->audio_buf = audio_buf;
+    sample->audio_len = header.audio_len;
+    sample->audio_cur = 0;
+    return true;
+}
+
+void save_sample_cache(const char *cache_path, Sample_Cache_Header header, Sample_S16 sample)
+{
+    FILE *f = fopen(cache_path, "wb");
+    if (f == NULL) {
+        println(stderr, "[WARN] Could not cache the converted sample to ", cache_path, ": ",
+                strerror(errno));
+        return;
     }
+    defer(fclose(f));
+
+    header.audio_len = sample.audio_len;
+    fwrite(&header, sizeof(header), 1, f);
+    fwrite(sample.audio_buf, sizeof(int16_t), sample.audio_len, f);
 }
 
+// NOTE: any WAV that SDL can read is converted to the mixer format
+// (SOMETHING_SOUND_FORMAT, SOMETHING_SOUND_FREQ,
+// SOMETHING_SAMPLE_CHANNELS) here, once, so the audio callback never
+// does any per-sample conversion.
 Sample_S16 load_wav_as_sample_s16(const char *file_path)
 {
+    struct stat source_stat = {};
+    if (stat(file_path, &source_stat) < 0) {
+        println(stderr, "Failed to load ", file_path, ": ", strerror(errno));
+        abort();
+    }
+
+    char cache_path[256];
+    snprintf(cache_path, sizeof(cache_path), "%s.s16", file_path);
+
+    Sample_Cache_Header header = {};
+    header.magic = SAMPLE_CACHE_MAGIC;
+    header.version = SAMPLE_CACHE_VERSION;
+    header.source_size = (Uint64) source_stat.st_size;
+    header.source_mtime = (Sint64) source_stat.st_mtime;
+    header.freq = SOMETHING_SOUND_FREQ;
+    header.channels = SOMETHING_SAMPLE_CHANNELS;
+
     Sample_S16 sample = {};
+    if (load_sample_cache(cache_path, header, &sample)) {
+        return sample;
+    }
+
     SDL_AudioSpec want = {};
     if (SDL_LoadWAV(file_path, &want, (Uint8**) &sample.audio_buf, &sample.audio_len) == nullptr) {
         println(stderr, "SDL pooped itself: Failed to load ", file_path, ": ",
@@ -28,16 +531,45 @@ Sample_S16 load_wav_as_sample_s16(const char *file_path)
         abort();
     }
 
-    assert(SDL_AUDIO_BITSIZE(want.format) == 16);
-    assert(SDL_AUDIO_ISLITTLEENDIAN(want.format));
-    assert(SDL_AUDIO_ISSIGNED(want.format));
-    assert(SDL_AUDIO_ISINT(want.format));
-    assert(want.freq == SOMETHING_SOUND_FREQ);
-    assert(want.channels == SOMETHING_SOUND_CHANNELS);
-    assert(want.samples == SOMETHING_SOUND_SAMPLES);
+    SDL_AudioCVT cvt = {};
+    const int needed = SDL_BuildAudioCVT(
+        &cvt,
+        want.format, want.channels, want.freq,
+        (SDL_AudioFormat) SOMETHING_SOUND_FORMAT,
+        (Uint8) SOMETHING_SAMPLE_CHANNELS,
+        (int) SOMETHING_SOUND_FREQ);
+    if (needed < 0) {
+        println(stderr, "SDL pooped itself: Failed to convert ", file_path, ": ",
+                SDL_GetError());
+        abort();
+    }
+
+    if (needed > 0) {
+        println(stdout, "Converting ", file_path, " from ", want.freq, " Hz, ",
+                want.channels, " channel(s) to the mixer format...");
+
+        cvt.len = (int) sample.audio_len;
+        cvt.buf = (Uint8*) SDL_malloc((size_t) (cvt.len * cvt.len_mult));
+        assert(cvt.buf != NULL);
+        memcpy(cvt.buf, sample.audio_buf, sample.audio_len);
+        SDL_FreeWAV((Uint8*) sample.audio_buf);
+
+        if (SDL_ConvertAudio(&cvt) < 0) {
+            println(stderr, "SDL pooped itself: Failed to convert ", file_path, ": ",
+                    SDL_GetError());
+            abort();
+        }
+
+        sample.audio_buf = (int16_t*) cvt.buf;
+        sample.audio_len = (Uint32) cvt.len_cvt;
+    }
 
     sample.audio_len /= 2;
 
+    if (needed > 0) {
+        save_sample_cache(cache_path, header, sample);
+    }
+
     return sample;
 }
 
@@ -52,28 +584,204 @@ Sample_S16 load_wav_as_sample_s16(String_View file_path)
     return result;
 }
 
+// NOTE: acc[i] += input[i] * gain
+void mix_add_s16(float *acc, const int16_t *input, size_t n, float gain)
+{
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256 g = _mm256_set1_ps(gain);
+    for (; i + 8 <= n; i += 8) {
+        const __m128i x = _mm_loadu_si128((const __m128i *) (input + i));
+        const __m256 f = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(x));
+        _mm256_storeu_ps(acc + i, _mm256_add_ps(_mm256_loadu_ps(acc + i), _mm256_mul_ps(f, g)));
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    const __m128 g = _mm_set1_ps(gain);
+    for (; i + 8 <= n; i += 8) {
+        const __m128i x = _mm_loadu_si128((const __m128i *) (input + i));
+        // NOTE: sign extension of int16 to int32 without SSE4.1
+        const __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16));
+        const __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16));
+        _mm_storeu_ps(acc + i,     _mm_add_ps(_mm_loadu_ps(acc + i),     _mm_mul_ps(lo, g)));
+        _mm_storeu_ps(acc + i + 4, _mm_add_ps(_mm_loadu_ps(acc + i + 4), _mm_mul_ps(hi, g)));
+    }
+#endif
+    for (; i < n; ++i) {
+        acc[i] += (float) input[i] * gain;
+    }
+}
+
+// NOTE: acc[2*i] += input[i] * gain_left
+//       acc[2*i + 1] += input[i] * gain_right
+void mix_add_s16_mono_to_stereo(float *acc, const int16_t *input, size_t frames,
+                                float gain_left, float gain_right)
+{
+    size_t i = 0;
+#if defined(__SSE2__) || defined(_M_X64) || defined(__AVX2__)
+    const __m128 g = _mm_setr_ps(gain_left, gain_right, gain_left, gain_right);
+    for (; i + 8 <= frames; i += 8) {
+        const __m128i x = _mm_loadu_si128((const __m128i *) (input + i));
+        const __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16));
+        const __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16));
+        float *out = acc + 2 * i;
+        // NOTE: duplicating every frame into a left/right pair
+        _mm_storeu_ps(out,      _mm_add_ps(_mm_loadu_ps(out),      _mm_mul_ps(_mm_unpacklo_ps(lo, lo), g)));
+        _mm_storeu_ps(out + 4,  _mm_add_ps(_mm_loadu_ps(out + 4),  _mm_mul_ps(_mm_unpackhi_ps(lo, lo), g)));
+        _mm_storeu_ps(out + 8,  _mm_add_ps(_mm_loadu_ps(out + 8),  _mm_mul_ps(_mm_unpacklo_ps(hi, hi), g)));
+        _mm_storeu_ps(out + 12, _mm_add_ps(_mm_loadu_ps(out + 12), _mm_mul_ps(_mm_unpackhi_ps(hi, hi), g)));
+    }
+#endif
+    for (; i < frames; ++i) {
+        acc[2 * i]     += (float) input[i] * gain_left;
+        acc[2 * i + 1] += (float) input[i] * gain_right;
+    }
+}
+
+// NOTE: output[i] = saturate_s16(acc[i])
+void mix_saturate_s16(const float *acc, int16_t *output, size_t n)
+{
+    size_t i = 0;
+#if defined(__SSE2__) || defined(_M_X64) || defined(__AVX2__)
+    // NOTE: clamping in float first, because out of range values
+    // become INT32_MIN in _mm_cvtps_epi32 which would saturate to the
+    // wrong end.
+    const __m128 low = _mm_set1_ps((float) INT16_MIN);
+    const __m128 high = _mm_set1_ps((float) INT16_MAX);
+    for (; i + 8 <= n; i += 8) {
+        const __m128 a = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(acc + i),     low), high);
+        const __m128 b = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(acc + i + 4), low), high);
+        const __m128i x = _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+        _mm_storeu_si128((__m128i *) (output + i), x);
+    }
+#endif
+    for (; i < n; ++i) {
+        output[i] = (int16_t) lrintf(clamp(acc[i], (float) INT16_MIN, (float) INT16_MAX));
+    }
+}
+
+// NOTE: never waits for the reader thread. Whatever is missing from
+// the ring is counted as an underrun and left silent.
+void Sample_Mixer::mix_music(size_t frames)
+{
+    const float gain = music_gain * volume;
+    size_t mixed = 0;
+    while (mixed < frames) {
+        size_t count = 0;
+        const int16_t *span = music.peek(&count);
+        const size_t n = min(frames - mixed, count / music.channels);
+        if (n == 0) break;
+
+        float *acc = buffer + mixed * SOMETHING_SOUND_CHANNELS;
+        if (music.channels == SOMETHING_SOUND_CHANNELS) {
+            mix_add_s16(acc, span, n * SOMETHING_SOUND_CHANNELS, gain);
+        } else {
+            mix_add_s16_mono_to_stereo(acc, span, n, gain, gain);
+        }
+
+        music.consume(n * music.channels);
+        mixed += n;
+    }
+
+    if (mixed < frames) {
+        if (SDL_AtomicGet(&music.finished)) {
+            music_playing = false;
+        } else {
+            SDL_AtomicAdd(&music.underruns, 1);
+        }
+    }
+}
+
+// NOTE: accumulates all of the active voices into the float buffer
+// over contiguous spans (no per-sample bounds checks), applying the
+// voice gain and the master volume in the same pass, and saturates to
+// int16 only once at the end.
+void Sample_Mixer::mix(int16_t *output, size_t output_len)
+{
+    for (size_t offset = 0; offset < output_len; offset += SAMPLE_MIXER_BUFFER_CAPACITY) {
+        const size_t n = min(output_len - offset, SAMPLE_MIXER_BUFFER_CAPACITY);
+        memset(buffer, 0, n * sizeof(buffer[0]));
+
+        for (size_t i = 0; i < SAMPLE_MIXER_CAPACITY; ++i) {
+            Mixer_Voice *voice = &voices[i];
+            if (!voice->active()) continue;
+
+            const size_t frames = min(n / SOMETHING_SOUND_CHANNELS,
+                                      (size_t) (voice->sample.audio_len - voice->sample.audio_cur));
+            mix_add_s16_mono_to_stereo(buffer,
+                                       voice->sample.audio_buf + voice->sample.audio_cur,
+                                       frames,
+                                       voice->gain_left * volume,
+                                       voice->gain_right * volume);
+            voice->sample.audio_cur += (Uint32) frames;
+        }
+
+        if (music_playing) {
+            mix_music(n / SOMETHING_SOUND_CHANNELS);
+        }
+
+        mix_saturate_s16(buffer, output + offset, n);
+    }
+}
+
+void Mixer_Stats::reset()
+{
+    SDL_AtomicSet(&callbacks, 0);
+    SDL_AtomicSet(&duration_us, 0);
+    SDL_AtomicSet(&max_duration_us, 0);
+    SDL_AtomicSet(&dropped, 0);
+    SDL_AtomicSet(&culled, 0);
+    SDL_AtomicSet(&late, 0);
+    SDL_AtomicSet(&overruns, 0);
+    for (size_t i = 0; i < MIXER_STATS_HISTOGRAM_SIZE; ++i) {
+        SDL_AtomicSet(&histogram[i], 0);
+    }
+}
+
+size_t Sample_Mixer::count_active_voices() const
+{
+    size_t result = 0;
+    for (size_t i = 0; i < SAMPLE_MIXER_CAPACITY; ++i) {
+        if (voices[i].active()) result += 1;
+    }
+    return result;
+}
+
 void sample_mixer_audio_callback(void *userdata, Uint8 *stream, int len)
 {
     Sample_Mixer *mixer = (Sample_Mixer *)userdata;
+    profile_thread_name("Audio");
+    PROFILE_ZONE("Mix");
+    const Uint64 begin = SDL_GetPerformanceCounter();
+
+    mixer->process_commands();
 
     int16_t *output = (int16_t *)stream;
     size_t output_len = (size_t) len / sizeof(*output);
 
-    memset(stream, 0, (size_t) len);
-    for (size_t i = 0; i < SAMPLE_MIXER_CAPACITY; ++i) {
-        for (size_t j = 0; j < output_len; ++j) {
-            int16_t x = 0;
+    mixer->mix(output, output_len);
 
-            if (mixer->samples[i].audio_cur < mixer->samples[i].audio_len) {
-                x = mixer->samples[i].audio_buf[mixer->samples[i].audio_cur];
-                mixer->samples[i].audio_cur += 1;
-            }
+    const Uint64 end = SDL_GetPerformanceCounter();
+    const Uint64 frequency = SDL_GetPerformanceFrequency();
+    const Uint64 period = (Uint64) (output_len / SOMETHING_SOUND_CHANNELS) * frequency / SOMETHING_SOUND_FREQ;
+    const Uint64 duration = end - begin;
 
-            output[j] = (int16_t) clamp(output[j] + x, (int) INT16_MIN, (int) INT16_MAX);
-        }
+    Mixer_Stats *stats = &mixer->stats;
+    const int duration_us = (int) (duration * 1000000 / frequency);
+    SDL_AtomicAdd(&stats->callbacks, 1);
+    SDL_AtomicSet(&stats->duration_us, duration_us);
+    SDL_AtomicSet(&stats->max_duration_us, max(SDL_AtomicGet(&stats->max_duration_us), duration_us));
+    SDL_AtomicSet(&stats->period_us, (int) (period * 1000000 / frequency));
+    SDL_AtomicSet(&stats->active_voices, (int) mixer->count_active_voices());
+    if (duration > period) {
+        SDL_AtomicAdd(&stats->overruns, 1);
     }
-
-    for (size_t i = 0; i < output_len; ++i) {
-        output[i] = (int16_t) (output[i] * mixer->volume);
+    if (mixer->last_callback != 0 && (begin - mixer->last_callback) * 2 > period * 3) {
+        SDL_AtomicAdd(&stats->late, 1);
+    }
+    if (period > 0) {
+        const size_t bucket = min((size_t) (duration * MIXER_STATS_HISTOGRAM_SIZE / period),
+                                  MIXER_STATS_HISTOGRAM_SIZE - 1);
+        SDL_AtomicAdd(&stats->histogram[bucket], 1);
     }
+    mixer->last_callback = begin;
 }
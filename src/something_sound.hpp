@@ -8,21 +8,213 @@ struct Sample_S16
     Uint32 audio_cur;
 };
 
-const size_t SAMPLE_MIXER_CAPACITY = 5;
+const size_t SOMETHING_SOUND_FREQ = 48000;
+const size_t SOMETHING_SOUND_FORMAT = 32784;
+const size_t SOMETHING_SOUND_CHANNELS = 2;
+// NOTE: the samples are mono and get panned into the stereo output
+const size_t SOMETHING_SAMPLE_CHANNELS = 1;
+const size_t SOMETHING_SOUND_SAMPLES = 4096;
+
+// NOTE: the mixing cost is bounded by this, no matter how many
+// sounds the game asks to play. See Sample_Mixer::allocate_voice() for
+// what happens when it's not enough.
+const size_t SAMPLE_MIXER_CAPACITY = 32;
+// NOTE: how many output values are mixed per pass over the voices
+const size_t SAMPLE_MIXER_BUFFER_CAPACITY = SOMETHING_SOUND_SAMPLES * SOMETHING_SOUND_CHANNELS;
+// NOTE: must be a power of two
+const size_t MIXER_COMMANDS_CAPACITY = 256;
+
+// NOTE: in int16 values, must be a power of two. About 0.7 seconds
+// of stereo at SOMETHING_SOUND_FREQ.
+const size_t SAMPLE_STREAM_CAPACITY = 64 * 1024;
+// NOTE: in int16 values, how much the reader thread reads at once
+const size_t SAMPLE_STREAM_CHUNK = 4096;
+const Uint32 SAMPLE_STREAM_IDLE_MS = 5;
+
+// NOTE: a 16-bit PCM WAV played straight from the disk. The reader
+// thread is the only one that writes into the ring and the audio
+// callback is the only one that reads from it, the same way as with
+// Mixer_Command_Queue.
+struct Sample_Stream
+{
+    // Reader thread side
+    FILE *file;
+    long data_begin;
+    Uint32 data_size;
+    Uint32 data_read;
+    bool looping;
+    SDL_Thread *thread;
+    SDL_atomic_t quit;
+
+    // Shared
+    size_t channels;
+    int16_t ring[SAMPLE_STREAM_CAPACITY];
+    SDL_atomic_t begin;         // written only by the audio callback
+    SDL_atomic_t end;           // written only by the reader thread
+    SDL_atomic_t finished;      // the reader reached the end of the file
+    SDL_atomic_t underruns;     // the callback wanted more than there was
+
+    // Game thread side
+    bool open(const char *file_path, bool looping);
+    void close();
+
+    // Reader thread side
+    bool fill();
+
+    // Audio thread side
+    const int16_t *peek(size_t *count);
+    void consume(size_t count);
+};
+
+enum class Mixer_Command_Type
+{
+    Play = 0,
+    Stop_All,
+    Set_Volume,
+    Play_Music,
+    Stop_Music,
+};
+
+struct Sound_Params
+{
+    // NOTE: a voice can only be stolen by a sound with the same or
+    // higher priority
+    int priority;
+    // NOTE: at most that many voices play the same sample at the same
+    // time. 0 means no limit.
+    int max_instances;
+    float gain;
+};
+
+struct Mixer_Voice
+{
+    Sample_S16 sample;
+    float gain_left;
+    float gain_right;
+    int priority;
+    Uint64 started;             // NOTE: for picking the oldest voice
+
+    bool active() const
+    {
+        return sample.audio_cur < sample.audio_len;
+    }
+
+    float loudness() const
+    {
+        return max(gain_left, gain_right);
+    }
+};
+
+struct Mixer_Command
+{
+    Mixer_Command_Type type;
+    Mixer_Voice voice;
+    int max_instances;
+    float volume;
+};
+
+// NOTE: lock-free single-producer/single-consumer ring. The game
+// thread is the only one that pushes and the audio callback is the
+// only one that pops, so neither of them ever waits on the other.
+struct Mixer_Command_Queue
+{
+    Mixer_Command items[MIXER_COMMANDS_CAPACITY];
+    SDL_atomic_t begin;         // written only by the consumer
+    SDL_atomic_t end;           // written only by the producer
+
+    bool push(Mixer_Command command);
+    bool pop(Mixer_Command *command);
+    bool empty();
+};
+
+const size_t MIXER_STATS_HISTOGRAM_SIZE = 8;
+
+// NOTE: written by the audio callback (and by the game thread for the
+// requests it throws away), readable from any thread at any time. Every
+// field is a separate atomic, so a reader may see a slightly torn
+// snapshot, which is fine for the console and the debug overlay.
+struct Mixer_Stats
+{
+    SDL_atomic_t callbacks;
+    SDL_atomic_t duration_us;       // of the last callback
+    SDL_atomic_t max_duration_us;
+    SDL_atomic_t period_us;         // of the last buffer
+    SDL_atomic_t active_voices;     // after the last callback
+    SDL_atomic_t dropped;           // play requests that never got a voice
+    SDL_atomic_t culled;            // positional requests that were too quiet
+    SDL_atomic_t late;              // callbacks more than 1.5 periods apart
+    SDL_atomic_t overruns;          // callbacks that took longer than the period
+    // NOTE: callback duration in 1/MIXER_STATS_HISTOGRAM_SIZE of the
+    // period. The last bucket also takes everything above the period.
+    SDL_atomic_t histogram[MIXER_STATS_HISTOGRAM_SIZE];
+
+    void reset();
+};
 
 struct Sample_Mixer
 {
+    // Game thread side
+    Mixer_Command_Queue commands;
+    // NOTE: where the positional sounds are heard from. Game::update
+    // keeps it at the camera.
+    Vec2f listener;
+
+    void play_sample(Sample_S16 sample, Sound_Params params);
+    void play_sample_at(Sample_S16 sample, Sound_Params params, Vec2f pos);
+    void stop_all();
+    void set_volume(float volume);
+    void sync();
+    void push_waiting(Mixer_Command command);
+    bool play_music(const char *file_path, float gain);
+    void stop_music();
+
+    Sample_Stream music;
+    Mixer_Stats stats;
+    // NOTE: set when no audio device is open (the headless replays).
+    // Nothing pops the commands then, so the game thread applies them
+    // itself instead of waiting for the audio callback forever.
+    bool no_device;
+
+    // Audio thread side. Only sample_mixer_audio_callback touches it.
     float volume;
-    Sample_S16 samples[SAMPLE_MIXER_CAPACITY];
+    Mixer_Voice voices[SAMPLE_MIXER_CAPACITY];
+    Uint64 voices_started;
+    bool music_playing;
+    float music_gain;
+    Uint64 last_callback;
+    float buffer[SAMPLE_MIXER_BUFFER_CAPACITY];
 
-    void play_sample(Sample_S16 sample);
-    void clean();
+    Mixer_Voice *allocate_voice(Mixer_Voice voice, int max_instances);
+    void process_commands();
+    void mix_music(size_t frames);
+    void mix(int16_t *output, size_t output_len);
+    size_t count_active_voices() const;
 };
 
-const size_t SOMETHING_SOUND_FREQ = 48000;
-const size_t SOMETHING_SOUND_FORMAT = 32784;
-const size_t SOMETHING_SOUND_CHANNELS = 1;
-const size_t SOMETHING_SOUND_SAMPLES = 4096;
+void mix_add_s16(float *acc, const int16_t *input, size_t n, float gain);
+void mix_add_s16_mono_to_stereo(float *acc, const int16_t *input, size_t frames,
+                                float gain_left, float gain_right);
+void mix_saturate_s16(const float *acc, int16_t *output, size_t n);
+
+// NOTE: the samples that had to be converted to the mixer format are
+// cached next to the source file as <file>.s16 and reused as long as
+// the size and the modification time of the source match
+const Uint32 SAMPLE_CACHE_MAGIC = 0x36315343; // "CS16"
+const Uint32 SAMPLE_CACHE_VERSION = 1;
+
+struct Sample_Cache_Header
+{
+    Uint32 magic;
+    Uint32 version;
+    Uint64 source_size;
+    Sint64 source_mtime;
+    Uint32 freq;
+    Uint32 channels;
+    Uint32 audio_len;
+};
+
+bool load_sample_cache(const char *cache_path, Sample_Cache_Header expected, Sample_S16 *sample);
+void save_sample_cache(const char *cache_path, Sample_Cache_Header header, Sample_S16 sample);
 
 struct Sample_S16_File
 {
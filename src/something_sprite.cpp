@@ -18,33 +18,35 @@ void Sprite::render(SDL_Renderer *renderer,
                     Rectf destrect,
                     SDL_RendererFlip flip,
                     RGBA shade) const
+{
+    render(renderer, destrect, flip, rgba_to_sdl(shade));
+}
+
+void Sprite::render(SDL_Renderer *renderer,
+                    Rectf destrect,
+                    SDL_RendererFlip flip,
+                    SDL_Color sdl_shade) const
 {
     if (texture_index.unwrap < assets.textures_count) {
         SDL_Rect rect = rectf_for_sdl(destrect);
-        SDL_Color sdl_shade = rgba_to_sdl(shade);
-
-        sec(SDL_RenderCopyEx(
-                renderer,
-                assets.textures[texture_index.unwrap].unwrap.texture,
-                &srcrect,
-                &rect,
-                0.0,
-                nullptr,
-                flip));
-
-        sec(SDL_SetTextureColorMod(
-                assets.textures[texture_index.unwrap].unwrap.texture_mask,
-                sdl_shade.r, sdl_shade.g, sdl_shade.b));
-        sec(SDL_SetTextureAlphaMod(assets.textures[texture_index.unwrap].unwrap.texture_mask, sdl_shade.a));
-
-        sec(SDL_RenderCopyEx(
-                renderer,
-                assets.textures[texture_index.unwrap].unwrap.texture_mask,
-                &srcrect,
-                &rect,
-                0.0,
-                nullptr,
-                flip));
+
+        render_copy_ex(
+            renderer,
+            assets.textures[texture_index.unwrap].unwrap.texture,
+            &srcrect,
+            &rect,
+            flip);
+
+        render_texture_mod(
+            assets.textures[texture_index.unwrap].unwrap.texture_mask,
+            sdl_shade);
+
+        render_copy_ex(
+            renderer,
+            assets.textures[texture_index.unwrap].unwrap.texture_mask,
+            &srcrect,
+            &rect,
+            flip);
     }
 }
 
@@ -63,38 +65,90 @@ void Sprite::render(SDL_Renderer *renderer,
     render(renderer, destrect, flip, shade);
 }
 
-void Frame_Animat::reset()
+void Frame_Animat_Playback::play(Frame_Animat_Index that)
+{
+    if (animat != that) {
+        animat = that;
+        reset();
+    }
+    paused = false;
+}
+
+void Frame_Animat_Playback::reset()
 {
     frame_current = 0;
+    frame_cooldown = 0.0f;
+}
+
+bool Frame_Animat_Playback::finished() const
+{
+    if (animat.unwrap < assets.animats_count) {
+        const Frame_Animat &clip = assets.animats[animat.unwrap].unwrap;
+        return clip.frame_count == 0 || frame_current == clip.frame_count - 1;
+    }
+
+    return true;
+}
+
+void Frame_Animat_Playback::render(SDL_Renderer *renderer,
+                                   Rectf dstrect,
+                                   SDL_RendererFlip flip,
+                                   RGBA shade) const
+{
+    if (animat.unwrap < assets.animats_count) {
+        const Frame_Animat &clip = assets.animats[animat.unwrap].unwrap;
+        if (clip.frame_count > 0) {
+            clip.frames[frame_current % clip.frame_count].render(renderer, dstrect, flip, shade);
+        }
+    }
 }
 
-void Frame_Animat::render(SDL_Renderer *renderer,
-                          Rectf dstrect,
-                          SDL_RendererFlip flip,
-                          RGBA shade) const
+void Frame_Animat_Playback::render(SDL_Renderer *renderer,
+                                   Rectf dstrect,
+                                   SDL_RendererFlip flip,
+                                   SDL_Color shade) const
 {
-    if (frame_count > 0) {
-        frames[frame_current % frame_count].render(renderer, dstrect, flip, shade);
+    if (animat.unwrap < assets.animats_count) {
+        const Frame_Animat &clip = assets.animats[animat.unwrap].unwrap;
+        if (clip.frame_count > 0) {
+            clip.frames[frame_current % clip.frame_count].render(renderer, dstrect, flip, shade);
+        }
     }
 }
 
-void Frame_Animat::render(SDL_Renderer *renderer,
-                          Vec2f pos,
-                          SDL_RendererFlip flip,
-                          RGBA shade) const
+void Frame_Animat_Playback::render(SDL_Renderer *renderer,
+                                   Vec2f pos,
+                                   SDL_RendererFlip flip,
+                                   RGBA shade) const
 {
-    if (frame_count > 0) {
-        frames[frame_current % frame_count].render(renderer, pos, flip, shade);
+    if (animat.unwrap < assets.animats_count) {
+        const Frame_Animat &clip = assets.animats[animat.unwrap].unwrap;
+        if (clip.frame_count > 0) {
+            clip.frames[frame_current % clip.frame_count].render(renderer, pos, flip, shade);
+        }
     }
 }
 
-void Frame_Animat::update(float dt)
+// NOTE: advances all of the playing animations in a single pass once
+// per simulation tick. Every instance has its own frame counter, so N
+// entities sharing a clip no longer speed it up N times.
+void update_frame_animat_playbacks(Frame_Animat_Playback *playbacks,
+                                   size_t playbacks_count,
+                                   float dt)
 {
-    if (dt < frame_cooldown) {
-        frame_cooldown -= dt;
-    } else if (frame_count > 0) {
-        frame_current = (frame_current + 1) % frame_count;
-        frame_cooldown = frame_duration;
+    for (size_t i = 0; i < playbacks_count; ++i) {
+        Frame_Animat_Playback *playback = &playbacks[i];
+        if (playback->paused || playback->animat.unwrap >= assets.animats_count) {
+            continue;
+        }
+
+        const Frame_Animat &clip = assets.animats[playback->animat.unwrap].unwrap;
+        if (dt < playback->frame_cooldown) {
+            playback->frame_cooldown -= dt;
+        } else if (clip.frame_count > 0) {
+            playback->frame_current = (playback->frame_current + 1) % clip.frame_count;
+            playback->frame_cooldown = clip.frame_duration;
+        }
     }
 }
 
@@ -16,17 +16,34 @@ struct Sprite
                 Vec2f pos,
                 SDL_RendererFlip flip = SDL_FLIP_NONE,
                 RGBA shade = {0, 0, 0, 0}) const;
+    // NOTE: for the callers that convert the shades of many sprites
+    // at once with rgba_to_sdl_batch()
+    void render(SDL_Renderer *renderer,
+                Rectf destrect,
+                SDL_RendererFlip flip,
+                SDL_Color shade) const;
 };
 
+// NOTE: Frame_Animat is an immutable animation clip shared by
+// everyone through Assets. The state of a particular instance playing
+// the clip lives in Frame_Animat_Playback.
 struct Frame_Animat
 {
     Sprite *frames;
     size_t  frame_count;
-    size_t  frame_current;
     float frame_duration;
+};
+
+struct Frame_Animat_Playback
+{
+    Frame_Animat_Index animat;
+    size_t frame_current;
     float frame_cooldown;
+    bool paused;
 
+    void play(Frame_Animat_Index animat);
     void reset();
+    bool finished() const;
 
     void render(SDL_Renderer *renderer,
                 Rectf dstrect,
@@ -38,8 +55,14 @@ struct Frame_Animat
                 SDL_RendererFlip flip = SDL_FLIP_NONE,
                 RGBA shade = {0, 0, 0, 0}) const;
 
-    void update(float dt);
+    void render(SDL_Renderer *renderer,
+                Rectf dstrect,
+                SDL_RendererFlip flip,
+                SDL_Color shade) const;
 };
 
+void update_frame_animat_playbacks(Frame_Animat_Playback *playbacks,
+                                   size_t playbacks_count,
+                                   float dt);
 
 #endif  // SOMETHING_SPRITE_HPP_
@@ -0,0 +1,232 @@
+#include "./something_state_hash.hpp"
+
+const uint64_t XXH_PRIME64_1 = 0x9E3779B185EBCA87ULL;
+const uint64_t XXH_PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+const uint64_t XXH_PRIME64_3 = 0x165667B19E3779F9ULL;
+const uint64_t XXH_PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+const uint64_t XXH_PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+static uint64_t rotl64(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+static uint64_t xxh64_round(uint64_t acc, uint64_t input)
+{
+    acc += input * XXH_PRIME64_2;
+    acc = rotl64(acc, 31);
+    return acc * XXH_PRIME64_1;
+}
+
+static uint64_t xxh64_merge_round(uint64_t acc, uint64_t value)
+{
+    acc ^= xxh64_round(0, value);
+    return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+}
+
+static uint64_t xxh64_read64(const uint8_t *p)
+{
+    uint64_t x = 0;
+    memcpy(&x, p, sizeof(x));
+    return x;
+}
+
+static uint32_t xxh64_read32(const uint8_t *p)
+{
+    uint32_t x = 0;
+    memcpy(&x, p, sizeof(x));
+    return x;
+}
+
+// NOTE: XXH64 (https://github.com/Cyan4973/xxHash). The four lanes are
+// independent, which is what makes it run at the memory speed on the
+// big arrays of entities. Assumes a little-endian machine, like the
+// snapshots do.
+static uint64_t xxh64(const void *data, size_t size, uint64_t seed)
+{
+    const uint8_t *p = (const uint8_t*) data;
+    const uint8_t *end = p + size;
+    uint64_t hash = 0;
+
+    if (size >= 32) {
+        uint64_t v1 = seed + XXH_PRIME64_1 + XXH_PRIME64_2;
+        uint64_t v2 = seed + XXH_PRIME64_2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - XXH_PRIME64_1;
+        for (; end - p >= 32; p += 32) {
+            v1 = xxh64_round(v1, xxh64_read64(p));
+            v2 = xxh64_round(v2, xxh64_read64(p + 8));
+            v3 = xxh64_round(v3, xxh64_read64(p + 16));
+            v4 = xxh64_round(v4, xxh64_read64(p + 24));
+        }
+        hash = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        hash = xxh64_merge_round(hash, v1);
+        hash = xxh64_merge_round(hash, v2);
+        hash = xxh64_merge_round(hash, v3);
+        hash = xxh64_merge_round(hash, v4);
+    } else {
+        hash = seed + XXH_PRIME64_5;
+    }
+
+    hash += (uint64_t) size;
+
+    for (; end - p >= 8; p += 8) {
+        hash ^= xxh64_round(0, xxh64_read64(p));
+        hash = rotl64(hash, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+    }
+
+    if (end - p >= 4) {
+        hash ^= (uint64_t) xxh64_read32(p) * XXH_PRIME64_1;
+        hash = rotl64(hash, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+        p += 4;
+    }
+
+    for (; p < end; ++p) {
+        hash ^= (uint64_t) *p * XXH_PRIME64_5;
+        hash = rotl64(hash, 11) * XXH_PRIME64_1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= XXH_PRIME64_2;
+    hash ^= hash >> 29;
+    hash *= XXH_PRIME64_3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+State_Hash hash_game_state(Game *game, World_Streamer *streamer)
+{
+    State_Hash result = {};
+    uint64_t *parts = result.parts;
+
+    // NOTE: the parts made of several arrays chain them through the seed
+    parts[STATE_HASH_ENTITIES] = xxh64(game->entities, sizeof(game->entities), 0);
+    parts[STATE_HASH_PROJECTILES] = xxh64(game->projectiles, sizeof(game->projectiles), 0);
+    parts[STATE_HASH_ITEMS] = xxh64(game->items, sizeof(game->items), 0);
+    parts[STATE_HASH_ANIMATS] = xxh64(game->animat_playbacks, sizeof(game->animat_playbacks), 0);
+
+    uint64_t camera = xxh64(&game->camera, sizeof(game->camera), 0);
+    camera = xxh64(game->camera_locks, sizeof(game->camera_locks[0]) * game->camera_locks_count, camera);
+    parts[STATE_HASH_CAMERA] = camera;
+
+    parts[STATE_HASH_RNGS] = xxh64(game->rngs, sizeof(game->rngs), 0);
+
+    uint64_t tiles = 0;
+    Vec2i begin = {};
+    Vec2i end = {};
+    if (loaded_rooms_bounds(streamer, &begin, &end)) {
+        tiles = xxh64(&begin, sizeof(begin), tiles);
+        tiles = xxh64(&end, sizeof(end), tiles);
+
+        static Tile row[TILE_GRID_WIDTH];
+        for (int y = begin.y; y < end.y; ++y) {
+            for (int x = begin.x; x < end.x; ++x) {
+                row[x - begin.x] = game->grid.get_tile(vec2(x, y));
+            }
+            tiles = xxh64(row, sizeof(row[0]) * (size_t) (end.x - begin.x), tiles);
+        }
+    }
+    parts[STATE_HASH_TILES] = tiles;
+
+    return result;
+}
+
+bool State_Hash_Log::start(const char *output_path, const char *reference_path)
+{
+    stop();
+
+    if (output_path != NULL) {
+        output = fopen(output_path, "w");
+        if (output == NULL) {
+            println(stderr, "Could not open file `", output_path, "`: ", strerror(errno));
+            return false;
+        }
+    }
+
+    if (reference_path != NULL) {
+        reference = fopen(reference_path, "r");
+        if (reference == NULL) {
+            println(stderr, "Could not open file `", reference_path, "`: ", strerror(errno));
+            stop();
+            return false;
+        }
+    }
+
+    ticks = 0;
+    diverged = false;
+    return true;
+}
+
+void State_Hash_Log::stop()
+{
+    if (output != NULL) {
+        if (ferror(output)) {
+            println(stderr, "[ERROR] Could not write the state hashes: ", strerror(errno));
+        }
+        fclose(output);
+        output = NULL;
+    }
+
+    if (reference != NULL) {
+        fclose(reference);
+        reference = NULL;
+    }
+}
+
+void State_Hash_Log::update(Game *game, World_Streamer *streamer)
+{
+    if (output == NULL && reference == NULL) return;
+    PROFILE_ZONE("State_Hash_Log::update");
+
+    ticks += 1;
+    const State_Hash hash = hash_game_state(game, streamer);
+
+    if (output != NULL) {
+        fprintf(output, "%llu", (unsigned long long) ticks);
+        for (size_t i = 0; i < STATE_HASH_PARTS_COUNT; ++i) {
+            fprintf(output, " %016llx", (unsigned long long) hash.parts[i]);
+        }
+        fputc('\n', output);
+    }
+
+    if (reference == NULL || diverged) return;
+
+    char line[256];
+    if (fgets(line, sizeof(line), reference) == NULL) {
+        println(stderr, "[WARN] The reference state hashes end before tick ", ticks);
+        fclose(reference);
+        reference = NULL;
+        return;
+    }
+
+    State_Hash expected = {};
+    char *p = line;
+    const uint64_t tick = strtoull(p, &p, 10);
+    for (size_t i = 0; i < STATE_HASH_PARTS_COUNT; ++i) {
+        expected.parts[i] = strtoull(p, &p, 16);
+    }
+
+    if (tick != ticks) {
+        println(stderr, "[ERROR] The reference state hashes are out of order: expected tick ",
+                ticks, " but got ", tick);
+        diverged = true;
+        return;
+    }
+
+    char parts[256] = {};
+    size_t parts_size = 0;
+    for (size_t i = 0; i < STATE_HASH_PARTS_COUNT; ++i) {
+        if (hash.parts[i] != expected.parts[i]) {
+            parts_size += (size_t) snprintf(parts + parts_size, sizeof(parts) - parts_size,
+                                            "%s%s", parts_size > 0 ? ", " : "",
+                                            state_hash_part_names[i]);
+        }
+    }
+
+    if (parts_size > 0) {
+        diverged = true;
+        println(stderr, "[DIVERGED] tick ", ticks, ": ", parts);
+        game->popup.notify(FONT_FAILURE_COLOR, "Diverged from the reference\n\ntick %d: %s",
+                           (int) ticks, parts);
+    }
+}
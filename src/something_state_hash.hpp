@@ -0,0 +1,58 @@
+#ifndef SOMETHING_STATE_HASH_HPP_
+#define SOMETHING_STATE_HASH_HPP_
+
+enum State_Hash_Part
+{
+    STATE_HASH_ENTITIES = 0,
+    STATE_HASH_PROJECTILES,
+    STATE_HASH_ITEMS,
+    STATE_HASH_ANIMATS,
+    STATE_HASH_CAMERA,
+    STATE_HASH_RNGS,
+    STATE_HASH_TILES,
+    STATE_HASH_PARTS_COUNT
+};
+
+const char *const state_hash_part_names[STATE_HASH_PARTS_COUNT] = {
+    "entities",
+    "projectiles",
+    "items",
+    "animats",
+    "camera",
+    "rngs",
+    "tiles",
+};
+
+// NOTE: one hash per part of the simulation state, so the first
+// divergent tick also tells which system diverged
+struct State_Hash
+{
+    uint64_t parts[STATE_HASH_PARTS_COUNT];
+};
+
+// NOTE: the structs are hashed as they are in memory, the same way the
+// snapshots store them. The tiles are hashed only in the part of the
+// grid the streamer has loaded, which is the only part that can change.
+State_Hash hash_game_state(Game *game, World_Streamer *streamer);
+
+// NOTE: writes the hash of every tick to `output` as a line of text
+//
+//   <tick> <entities> <projectiles> <items> <animats> <camera> <rngs> <tiles>
+//
+// and compares them with the lines of `reference`, which is the output
+// of another run of the same recording
+struct State_Hash_Log
+{
+    FILE *output;
+    FILE *reference;
+    uint64_t ticks;
+    bool diverged;
+
+    bool start(const char *output_path, const char *reference_path);
+    void stop();
+
+    // NOTE: right after Game::update
+    void update(Game *game, World_Streamer *streamer);
+};
+
+#endif  // SOMETHING_STATE_HASH_HPP_
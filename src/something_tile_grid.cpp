@@ -1,5 +1,42 @@
 #include "something_tile_grid.hpp"
 
+void Tile_Def::bake_particle_palette()
+{
+    particle_palette_count = 0;
+
+    if (top_texture.texture_index.unwrap >= assets.textures_count || top_texture.srcrect.w <= 0) {
+        return;
+    }
+
+    const auto surface = assets.textures[top_texture.texture_index.unwrap].unwrap.surface;
+    const size_t w = (size_t) top_texture.srcrect.w;
+    const size_t n = min(w, TILE_PARTICLE_PALETTE_CAPACITY);
+
+    sec(SDL_LockSurface(surface));
+    assert(surface->format->format == SDL_PIXELFORMAT_RGBA32);
+    for (size_t i = 0; i < n; ++i) {
+        const size_t x = i * w / n;
+        const auto pixel = *(Uint32*) ((uint8_t *) surface->pixels + top_texture.srcrect.y * surface->pitch + (top_texture.srcrect.x + x) * sizeof(Uint32));
+        SDL_Color color = {};
+        SDL_GetRGBA(
+            pixel,
+            surface->format,
+            &color.r,
+            &color.g,
+            &color.b,
+            &color.a);
+        particle_palette[particle_palette_count++] = sdl_to_rgba(color).to_hsla();
+    }
+    SDL_UnlockSurface(surface);
+}
+
+void bake_tile_particle_palettes()
+{
+    for (Tile tile = 0; tile < TILE_COUNT; ++tile) {
+        tile_defs[tile].bake_particle_palette();
+    }
+}
+
 Vec2i Tile_Grid::abs_to_tile_coord(Vec2f pos)
 {
     return vec2(
@@ -13,9 +50,265 @@ bool Tile_Grid::is_tile_coord_inbounds(Vec2i coord)
            0 <= coord.y && coord.y < (int) TILE_GRID_HEIGHT;
 }
 
+// NOTE: the cells covered by the in-bounds part of the room at `coord`.
+// `end` is inclusive.
+static bool room_cells_of(Vec2i coord, Vec2i *begin, Vec2i *end)
+{
+    const int x0 = max(coord.x, 0);
+    const int y0 = max(coord.y, 0);
+    const int x1 = min(coord.x + ROOM_WIDTH, (int) TILE_GRID_WIDTH);
+    const int y1 = min(coord.y + ROOM_HEIGHT, (int) TILE_GRID_HEIGHT);
+    if (x0 >= x1 || y0 >= y1) return false;
+
+    *begin = vec2(x0 / ROOM_WIDTH, y0 / ROOM_HEIGHT);
+    *end = vec2((x1 - 1) / ROOM_WIDTH, (y1 - 1) / ROOM_HEIGHT);
+    return true;
+}
+
+static bool rooms_overlap(Vec2i a, Vec2i b)
+{
+    return a.x < b.x + ROOM_WIDTH && b.x < a.x + ROOM_WIDTH &&
+           a.y < b.y + ROOM_HEIGHT && b.y < a.y + ROOM_HEIGHT;
+}
+
+// NOTE: returns false with the reason printed to stderr if the file
+// can not be opened or is corrupted
+static bool read_world_room_file(const char *filepath, Tile tiles[ROOM_HEIGHT][ROOM_WIDTH])
+{
+    World_File room = {};
+    if (!open_world_file(filepath, &room)) {
+        return false;
+    }
+    defer(close_world_file(&room));
+
+    if (room.header->width != ROOM_WIDTH || room.header->height != ROOM_HEIGHT) {
+        println(stderr, filepath, ": the room is ", room.header->width, "x", room.header->height,
+                ". Expected ", ROOM_WIDTH, "x", ROOM_HEIGHT);
+        return false;
+    }
+
+    for (size_t cy = 0; cy < room.chunks_height; ++cy) {
+        for (size_t cx = 0; cx < room.chunks_width; ++cx) {
+            if (!room.decode_chunk(cx, cy, &tiles[0][0], ROOM_WIDTH)) {
+                println(stderr, filepath, ": chunk (", cx, ", ", cy, ") is corrupted");
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static void read_room_file(const char *filepath, Tile tiles[ROOM_HEIGHT][ROOM_WIDTH])
+{
+    if (is_world_file(filepath)) {
+        if (!read_world_room_file(filepath, tiles)) {
+            abort();
+        }
+    } else {
+        // NOTE: the old format. ROOM_WIDTH * ROOM_HEIGHT raw tiles.
+        FILE *f = fopen(filepath, "rb");
+        if (f == NULL) {
+            println(stderr, "Could not load from file `", filepath, "`: ", strerror(errno));
+            abort();
+        }
+
+        size_t n = fread(tiles, sizeof(Tile), ROOM_WIDTH * ROOM_HEIGHT, f);
+        assert(n == ROOM_WIDTH * ROOM_HEIGHT);
+
+        fclose(f);
+    }
+}
+
+Maybe<Room_Template_Index> Tile_Grid::get_room_template_by_path(const char *filepath)
+{
+    for (size_t i = 0; i < room_templates_count; ++i) {
+        if (strcmp(room_templates[i].path, filepath) == 0) return {true, {i}};
+    }
+    return {};
+}
+
+Room_Template_Index Tile_Grid::load_room_template(const char *filepath)
+{
+    auto cached = get_room_template_by_path(filepath);
+    if (cached.has_value) {
+        return cached.unwrap;
+    }
+
+    if (room_templates_count >= ROOM_TEMPLATES_CAPACITY) {
+        println(stderr, "Too many room templates. The limit is ", ROOM_TEMPLATES_CAPACITY);
+        abort();
+    }
+
+    if (strlen(filepath) >= ROOM_TEMPLATE_PATH_CAPACITY) {
+        println(stderr, "Room file path `", filepath, "` is too long");
+        abort();
+    }
+
+    Room_Template_Index index = {room_templates_count++};
+    strcpy(room_templates[index.unwrap].path, filepath);
+    read_room_file(filepath, room_templates[index.unwrap].tiles);
+    return index;
+}
+
+void Tile_Grid::reload_room_template(Room_Template_Index index)
+{
+    assert(index.unwrap < room_templates_count);
+    read_room_file(room_templates[index.unwrap].path, room_templates[index.unwrap].tiles);
+}
+
+Room_Ref *Tile_Grid::room_ref_at(Vec2i coord)
+{
+    if (room_refs_count == 0) return NULL;
+
+    const auto &cell = room_cells[coord.y / ROOM_HEIGHT][coord.x / ROOM_WIDTH];
+    for (size_t k = 0; k < ROOM_CELL_REFS_CAPACITY; ++k) {
+        if (cell[k] == 0) continue;
+
+        Room_Ref *ref = &room_refs[cell[k] - 1];
+        if (ref->coord.x <= coord.x && coord.x < ref->coord.x + ROOM_WIDTH &&
+            ref->coord.y <= coord.y && coord.y < ref->coord.y + ROOM_HEIGHT)
+        {
+            return ref;
+        }
+    }
+
+    return NULL;
+}
+
+void Tile_Grid::drop_room_ref(Room_Ref *ref)
+{
+    assert(ref->alive);
+    const uint16_t id = (uint16_t) (ref - room_refs + 1);
+
+    Vec2i begin = {};
+    Vec2i end = {};
+    if (room_cells_of(ref->coord, &begin, &end)) {
+        for (int cy = begin.y; cy <= end.y; ++cy) {
+            for (int cx = begin.x; cx <= end.x; ++cx) {
+                for (auto &cell_ref : room_cells[cy][cx]) {
+                    if (cell_ref == id) cell_ref = 0;
+                }
+            }
+        }
+    }
+
+    ref->alive = false;
+    room_refs_count -= 1;
+}
+
+void Tile_Grid::materialize_room(Room_Ref *ref)
+{
+    const auto &templ = room_templates[ref->template_index.unwrap];
+    drop_room_ref(ref);
+
+    for (int dy = 0; dy < ROOM_HEIGHT; ++dy) {
+        for (int dx = 0; dx < ROOM_WIDTH; ++dx) {
+            set_tile(vec2(ref->coord.x + dx, ref->coord.y + dy), templ.tiles[dy][dx]);
+        }
+    }
+}
+
+void Tile_Grid::drop_all_rooms()
+{
+    memset(room_refs, 0, sizeof(room_refs));
+    memset(room_cells, 0, sizeof(room_cells));
+    room_refs_count = 0;
+}
+
+void Tile_Grid::instance_room(Room_Template_Index index, Vec2i coord)
+{
+    assert(index.unwrap < room_templates_count);
+
+    Vec2i begin = {};
+    Vec2i end = {};
+    if (!room_cells_of(coord, &begin, &end)) return;
+
+    // NOTE: the rooms under the new one keep their tiles that are
+    // outside of it. The ones that are fully covered are just dropped.
+    for (int cy = begin.y; cy <= end.y; ++cy) {
+        for (int cx = begin.x; cx <= end.x; ++cx) {
+            for (auto cell_ref : room_cells[cy][cx]) {
+                if (cell_ref == 0) continue;
+                Room_Ref *ref = &room_refs[cell_ref - 1];
+                if (!rooms_overlap(ref->coord, coord)) continue;
+
+                if (ref->coord.x == coord.x && ref->coord.y == coord.y) {
+                    ref->template_index = index;
+                    return;
+                }
+
+                materialize_room(ref);
+            }
+        }
+    }
+
+    size_t slot = 0;
+    while (slot < ROOM_REFS_CAPACITY && room_refs[slot].alive) {
+        slot += 1;
+    }
+
+    if (slot >= ROOM_REFS_CAPACITY) {
+        // NOTE: out of refs. The room gets its own copy of the tiles right away.
+        const auto &templ = room_templates[index.unwrap];
+        for (int dy = 0; dy < ROOM_HEIGHT; ++dy) {
+            for (int dx = 0; dx < ROOM_WIDTH; ++dx) {
+                set_tile(vec2(coord.x + dx, coord.y + dy), templ.tiles[dy][dx]);
+            }
+        }
+        return;
+    }
+
+    room_refs[slot].alive = true;
+    room_refs[slot].coord = coord;
+    room_refs[slot].template_index = index;
+    room_refs_count += 1;
+
+    for (int cy = begin.y; cy <= end.y; ++cy) {
+        for (int cx = begin.x; cx <= end.x; ++cx) {
+            size_t k = 0;
+            while (k < ROOM_CELL_REFS_CAPACITY && room_cells[cy][cx][k] != 0) {
+                k += 1;
+            }
+            assert(k < ROOM_CELL_REFS_CAPACITY);
+            room_cells[cy][cx][k] = (uint16_t) (slot + 1);
+        }
+    }
+}
+
+bool Tile_Grid::evict_room(Vec2i coord, Tile out[ROOM_HEIGHT][ROOM_WIDTH])
+{
+    Room_Ref *ref = is_tile_coord_inbounds(coord) ? room_ref_at(coord) : NULL;
+    const bool modified = !(ref && ref->coord.x == coord.x && ref->coord.y == coord.y);
+
+    for (int dy = 0; dy < ROOM_HEIGHT; ++dy) {
+        for (int dx = 0; dx < ROOM_WIDTH; ++dx) {
+            out[dy][dx] = get_tile(vec2(coord.x + dx, coord.y + dy));
+        }
+    }
+
+    if (!modified) {
+        drop_room_ref(ref);
+    }
+
+    for (int dy = 0; dy < ROOM_HEIGHT; ++dy) {
+        for (int dx = 0; dx < ROOM_WIDTH; ++dx) {
+            set_tile(vec2(coord.x + dx, coord.y + dy), TILE_EMPTY);
+        }
+    }
+
+    return modified;
+}
+
 Tile Tile_Grid::get_tile(Vec2i coord)
 {
     if (is_tile_coord_inbounds(coord))  {
+        const Room_Ref *ref = room_ref_at(coord);
+        if (ref) {
+            return room_templates[ref->template_index.unwrap]
+                .tiles[coord.y - ref->coord.y][coord.x - ref->coord.x];
+        }
+
         return tiles[coord.y][coord.x];
     }
 
@@ -25,6 +318,15 @@ Tile Tile_Grid::get_tile(Vec2i coord)
 void Tile_Grid::set_tile(Vec2i coord, Tile tile)
 {
     if (is_tile_coord_inbounds(coord)) {
+        Room_Ref *ref = room_ref_at(coord);
+        if (ref) {
+            if (room_templates[ref->template_index.unwrap]
+                    .tiles[coord.y - ref->coord.y][coord.x - ref->coord.x] == tile) {
+                return;
+            }
+            materialize_room(ref);
+        }
+
         tiles[coord.y][coord.x] = tile;
     }
 }
@@ -32,7 +334,7 @@ void Tile_Grid::set_tile(Vec2i coord, Tile tile)
 void Tile_Grid::copy_tile(Vec2i coord_dst, Vec2i coord_src)
 {
     if (is_tile_coord_inbounds(coord_dst) && is_tile_coord_inbounds(coord_src)) {
-        tiles[coord_dst.y][coord_dst.x] = tiles[coord_src.y][coord_src.x];
+        set_tile(coord_dst, get_tile(coord_src));
     }
 }
 
@@ -46,23 +348,20 @@ bool Tile_Grid::is_tile_empty_abs(Vec2f pos)
     return is_tile_empty_tile(abs_to_tile_coord(pos));
 }
 
-Tile *Tile_Grid::tile_at_abs(Vec2f pos)
-{
-    const Vec2i coord = abs_to_tile_coord(pos);
-    if (is_tile_coord_inbounds(coord)) {
-        return &tiles[coord.y][coord.x];
-    }
-
-    return NULL;
-}
-
 void Tile_Grid::render(SDL_Renderer *renderer, Camera camera, Recti *lock)
 {
+    Render_Subsystem_Scope scope(RENDER_SUBSYSTEM_TILES);
+
     const Vec2i begin = abs_to_tile_coord(
         camera.pos - vec2(SCREEN_WIDTH, SCREEN_HEIGHT) * 0.5f);
     const Vec2i end = abs_to_tile_coord(
         camera.pos + vec2(SCREEN_WIDTH, SCREEN_HEIGHT) * 0.5f);
 
+    // NOTE: there are only two shades, so they are converted once per
+    // frame instead of once per tile
+    const SDL_Color dim_shade = rgba_to_sdl(ROOM_NEIGHBOR_DIM_COLOR);
+    const SDL_Color no_shade = {0, 0, 0, 0};
+
     for (int y = begin.y; y <= end.y; ++y) {
         for (int x = begin.x; x <= end.x; ++x) {
             const auto coord = vec2(x, y);
@@ -71,10 +370,10 @@ void Tile_Grid::render(SDL_Renderer *renderer, Camera camera, Recti *lock)
                 camera.to_screen(vec2((float) x, (float) y) * TILE_SIZE),
                 TILE_SIZE, TILE_SIZE);
 
-            RGBA shade_color = ROOM_NEIGHBOR_DIM_COLOR;
+            SDL_Color shade_color = dim_shade;
 
             if (lock && rect_contains_vec2(*lock, coord)) {
-                shade_color = {0, 0, 0, 0};
+                shade_color = no_shade;
             }
 
             if (is_tile_empty_tile(vec2(coord.x, coord.y - 1))) {
@@ -189,19 +488,15 @@ Maybe<Vec2i> Tile_Grid::next_in_bfs(Vec2i dst, Recti *lock)
 void fill_rect(SDL_Renderer *renderer, Camera *camera,
                Rectf rectf, RGBA color)
 {
-    SDL_Color sdl_color = rgba_to_sdl(color);
-    sec(SDL_SetRenderDrawColor(
-            renderer,
-            sdl_color.r,
-            sdl_color.g,
-            sdl_color.b,
-            sdl_color.a));
+    render_draw_color(renderer, rgba_to_sdl(color));
     SDL_Rect rect = rectf_for_sdl(camera->to_screen(rectf));
-    sec(SDL_RenderFillRect(renderer, &rect));
+    render_fill_rect(renderer, &rect);
 }
 
 void Tile_Grid::render_debug_bfs_overlay(SDL_Renderer *renderer, Camera *camera, Recti *lock)
 {
+    Render_Subsystem_Scope scope(RENDER_SUBSYSTEM_TILES);
+
     for (int y = 0; y < lock->h; ++y) {
         for (int x = 0; x < lock->w; ++x) {
             fill_rect(
@@ -234,42 +529,24 @@ bool Tile_Grid::a_sees_b(Vec2f a, Vec2f b)
     return true;
 }
 
-void Tile_Grid::load_from_file(const char *filepath)
+void Tile_Grid::load_room_from_file(const char *filepath, Vec2i coord)
 {
-    FILE *f = fopen(filepath, "rb");
-    if (f == NULL) {
-        println(stderr, "Could not load from file `", filepath, "`: ", strerror(errno));
-        abort();
-    }
-
-    size_t n = fread(tiles, sizeof(Tile), TILE_GRID_WIDTH * TILE_GRID_HEIGHT, f);
-    assert(n == TILE_GRID_WIDTH * TILE_GRID_HEIGHT);
-
-    fclose(f);
+    instance_room(load_room_template(filepath), coord);
 }
 
-void Tile_Grid::load_room_from_file(const char *filepath, Vec2i coord)
+int Tile_Grid::save_room_to_file(const char *filepath, Recti room)
 {
     Tile tmp[ROOM_HEIGHT][ROOM_WIDTH] = {};
+    assert(room.w == ROOM_WIDTH);
+    assert(room.h == ROOM_HEIGHT);
 
-    FILE *f = fopen(filepath, "rb");
-    if (f == NULL) {
-        println(stderr, "Could not load from file `", filepath, "`: ", strerror(errno));
-        abort();
-    }
-
-    size_t n = fread(tmp, sizeof(Tile), ROOM_WIDTH * ROOM_HEIGHT, f);
-    assert(n == ROOM_WIDTH * ROOM_HEIGHT);
-
-    for (size_t dy = 0; dy < ROOM_HEIGHT; ++dy) {
-        for (size_t dx = 0; dx < ROOM_WIDTH; ++dx) {
-            size_t x = coord.x + dx;
-            size_t y = coord.y + dy;
-            if (x < (size_t) TILE_GRID_WIDTH && y < (size_t) TILE_GRID_HEIGHT) {
-                tiles[y][x] = tmp[dy][dx];
-            }
+    for (int dy = 0; dy < ROOM_HEIGHT; ++dy) {
+        for (int dx = 0; dx < ROOM_WIDTH; ++dx) {
+            tmp[dy][dx] = get_tile(vec2(room.x + dx, room.y + dy));
         }
     }
+
+    return save_world_file(filepath, &tmp[0][0], ROOM_WIDTH, ROOM_WIDTH, ROOM_HEIGHT);
 }
 
 Vec2f Tile_Grid::abs_center_of_tile(Vec2i coord)
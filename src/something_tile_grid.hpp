@@ -18,26 +18,40 @@ const Tile TILE_COUNT  = 10;
 const size_t TILE_GRID_WIDTH = 4096;
 const size_t TILE_GRID_HEIGHT = 4096;
 
+#include "./something_world.hpp"
+
+const size_t TILE_PARTICLE_PALETTE_CAPACITY = 64;
+
 struct Tile_Def
 {
     bool is_collidable;
     Sprite top_texture;
     Sprite bottom_texture;
+
+    // NOTE: colors of the top row of top_texture that the walking
+    // particles pick from. Baked by bake_tile_particle_palettes() so
+    // the simulation never has to touch the SDL surfaces.
+    HSLA particle_palette[TILE_PARTICLE_PALETTE_CAPACITY];
+    size_t particle_palette_count;
+
+    void bake_particle_palette();
 };
 
 Tile_Def tile_defs[TILE_COUNT] = {
-    {false, {}, {}},                          // TILE_EMPTY
-    {true, {}, {}},                           // TILE_WALL
-    {true, {}, {}},                           // TILE_DIRT_0
-    {true, {}, {}},                           // TILE_DIRT_1
-    {true, {}, {}},                           // TILE_DIRT_2
-    {true, {}, {}},                           // TILE_DIRT_3
-    {true, {}, {}},                           // TILE_ICE_0
-    {true, {}, {}},                           // TILE_ICE_1
-    {true, {}, {}},                           // TILE_ICE_2
-    {true, {}, {}},                           // TILE_ICE_3
+    {false, {}, {}, {}, 0},                   // TILE_EMPTY
+    {true, {}, {}, {}, 0},                    // TILE_WALL
+    {true, {}, {}, {}, 0},                    // TILE_DIRT_0
+    {true, {}, {}, {}, 0},                    // TILE_DIRT_1
+    {true, {}, {}, {}, 0},                    // TILE_DIRT_2
+    {true, {}, {}, {}, 0},                    // TILE_DIRT_3
+    {true, {}, {}, {}, 0},                    // TILE_ICE_0
+    {true, {}, {}, {}, 0},                    // TILE_ICE_1
+    {true, {}, {}, {}, 0},                    // TILE_ICE_2
+    {true, {}, {}, {}, 0},                    // TILE_ICE_3
 };
 
+void bake_tile_particle_palettes();
+
 const float TILE_SIZE = 128.0f * 0.5f;
 const float TILE_SIZE_SQR = TILE_SIZE * TILE_SIZE;
 
@@ -85,12 +99,58 @@ struct Queue
 
 using Room_Queue = Queue<Vec2i, ROOM_WIDTH * ROOM_HEIGHT>;
 
+const size_t ROOM_TEMPLATES_CAPACITY = 64;
+const size_t ROOM_TEMPLATE_PATH_CAPACITY = 256;
+const size_t ROOM_REFS_CAPACITY = 1024;
+// NOTE: the room refs never overlap, so a ROOM_WIDTH x ROOM_HEIGHT
+// cell is covered by at most 4 of them
+const size_t ROOM_CELL_REFS_CAPACITY = 4;
+const size_t ROOM_CELLS_WIDTH = (TILE_GRID_WIDTH + ROOM_WIDTH - 1) / ROOM_WIDTH;
+const size_t ROOM_CELLS_HEIGHT = (TILE_GRID_HEIGHT + ROOM_HEIGHT - 1) / ROOM_HEIGHT;
+
+struct Room_Template_Index: public Index<Room_Template_Index> {};
+
+struct Room_Template
+{
+    char path[ROOM_TEMPLATE_PATH_CAPACITY];
+    Tile tiles[ROOM_HEIGHT][ROOM_WIDTH];
+};
+
+// NOTE: a room of the grid that still reads its tiles from the
+// template. It is copied into Tile_Grid::tiles on the first write.
+struct Room_Ref
+{
+    bool alive;
+    Vec2i coord;
+    Room_Template_Index template_index;
+};
+
 struct Tile_Grid
 {
     Tile tiles[TILE_GRID_HEIGHT][TILE_GRID_WIDTH];
 
-    void load_from_file(const char *filepath);
+    Room_Template room_templates[ROOM_TEMPLATES_CAPACITY];
+    size_t room_templates_count;
+    Room_Ref room_refs[ROOM_REFS_CAPACITY];
+    size_t room_refs_count;
+    // NOTE: 1-based indices into room_refs. 0 is no ref.
+    uint16_t room_cells[ROOM_CELLS_HEIGHT][ROOM_CELLS_WIDTH][ROOM_CELL_REFS_CAPACITY];
+
+    Room_Template_Index load_room_template(const char *filepath);
+    Maybe<Room_Template_Index> get_room_template_by_path(const char *filepath);
+    void reload_room_template(Room_Template_Index index);
+    void instance_room(Room_Template_Index index, Vec2i coord);
+    Room_Ref *room_ref_at(Vec2i coord);
+    void drop_room_ref(Room_Ref *ref);
+    void materialize_room(Room_Ref *ref);
+    // NOTE: copies the room at `coord` into `out` and clears it from
+    // the grid. Returns false if the room was still an untouched
+    // instance of its template, that is there is nothing to save.
+    bool evict_room(Vec2i coord, Tile out[ROOM_HEIGHT][ROOM_WIDTH]);
+    void drop_all_rooms();
+
     void load_room_from_file(const char *filepath, Vec2i coord);
+    int save_room_to_file(const char *filepath, Recti room);
 
     void render(SDL_Renderer *renderer, Camera camera, Recti *lock);
     void resolve_point_collision(Vec2f *origin);
@@ -103,7 +163,6 @@ struct Tile_Grid
     bool is_tile_coord_inbounds(Vec2i coord);
     bool is_tile_empty_tile(Vec2i coord);
     bool is_tile_empty_abs(Vec2f pos);
-    Tile *tile_at_abs(Vec2f pos);
     Vec2f abs_center_of_tile(Vec2i coord);
     Rectf rect_of_tile(Vec2i coord);
 
@@ -16,14 +16,8 @@ static void render_tooltip(SDL_Renderer *renderer,
         (int) floorf(tooltip_box.x),
         (int) floorf(tooltip_box.y)
     };
-    const SDL_Color tooltip_background_color = rgba_to_sdl(TOOLTIP_BACKGROUND_COLOR);
-    sec(SDL_SetRenderDrawColor(
-            renderer,
-            tooltip_background_color.r,
-            tooltip_background_color.g,
-            tooltip_background_color.b,
-            tooltip_background_color.a));
-    sec(SDL_RenderFillRect(renderer, &tooltip_rect));
+    render_draw_color(renderer, rgba_to_sdl(TOOLTIP_BACKGROUND_COLOR));
+    render_fill_rect(renderer, &tooltip_rect);
     font.render(renderer, position + padding, size, TOOLTIP_FOREGROUND_COLOR, tooltip);
 }
 
@@ -56,24 +50,13 @@ void Toolbar::render(SDL_Renderer *renderer, Bitmap_Font font)
         auto hitbox = button_hitbox(i);
         const auto shade_rect = rectf_for_sdl(hitbox);
 
-        const SDL_Color toolbar_button_color = rgba_to_sdl(TOOLBAR_BUTTON_COLOR);
-        sec(SDL_SetRenderDrawColor(
-                renderer,
-                toolbar_button_color.r,
-                toolbar_button_color.g,
-                toolbar_button_color.b,
-                toolbar_button_color.a));
-        sec(SDL_RenderFillRect(renderer, &shade_rect));
+        render_draw_color(renderer, rgba_to_sdl(TOOLBAR_BUTTON_COLOR));
+        render_fill_rect(renderer, &shade_rect);
 
         buttons[i].icon.render(renderer, rect_shrink(hitbox, TOOLBAR_BUTTON_ICON_PADDING));
 
-        sec(SDL_SetRenderDrawColor(
-                renderer,
-                shade.r,
-                shade.g,
-                shade.b,
-                shade.a));
-        sec(SDL_RenderFillRect(renderer, &shade_rect));
+        render_draw_color(renderer, shade);
+        render_fill_rect(renderer, &shade_rect);
     }
 
     if (hovered_button.has_value) {
@@ -0,0 +1,347 @@
+#include "./something_world.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#else
+#include <windows.h>
+#endif // _WIN32
+
+static size_t world_put_varint(uint8_t *bytes, uint32_t x)
+{
+    size_t n = 0;
+    while (x >= 0x80) {
+        bytes[n++] = (uint8_t) (x | 0x80);
+        x >>= 7;
+    }
+    bytes[n++] = (uint8_t) x;
+    return n;
+}
+
+static bool world_get_varint(const uint8_t **p, const uint8_t *end, uint32_t *x)
+{
+    uint32_t result = 0;
+    for (uint32_t shift = 0; shift < 35; shift += 7) {
+        if (*p >= end) return false;
+        const uint8_t byte = *(*p)++;
+        result |= (uint32_t) (byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            *x = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool World_File::decode_chunk(size_t cx, size_t cy, Tile *dst, size_t stride) const
+{
+    assert(cx < chunks_width);
+    assert(cy < chunks_height);
+
+    const size_t x0 = cx * WORLD_CHUNK_SIZE;
+    const size_t y0 = cy * WORLD_CHUNK_SIZE;
+    const size_t w = min(WORLD_CHUNK_SIZE, (size_t) header->width - x0);
+    const size_t h = min(WORLD_CHUNK_SIZE, (size_t) header->height - y0);
+    const World_File_Chunk chunk = chunks[cy * chunks_width + cx];
+
+    if (chunk.size == 0) {
+        for (size_t y = 0; y < h; ++y) {
+            for (size_t x = 0; x < w; ++x) {
+                dst[(y0 + y) * stride + x0 + x] = TILE_EMPTY;
+            }
+        }
+        return true;
+    }
+
+    const uint8_t *p = data + chunk.offset;
+    const uint8_t *end = p + chunk.size;
+    const size_t n = w * h;
+    size_t i = 0;
+    while (i < n) {
+        uint32_t length = 0;
+        uint32_t tile = 0;
+        if (!world_get_varint(&p, end, &length) ||
+            !world_get_varint(&p, end, &tile) ||
+            length == 0 || length > n - i || tile >= TILE_COUNT)
+        {
+            return false;
+        }
+
+        for (uint32_t j = 0; j < length; ++j, ++i) {
+            dst[(y0 + i / w) * stride + x0 + i % w] = tile;
+        }
+    }
+
+    return p == end;
+}
+
+bool is_world_file(const char *filepath)
+{
+    FILE *f = fopen(filepath, "rb");
+    if (f == NULL) return false;
+    defer(fclose(f));
+
+    uint32_t magic = 0;
+    return fread(&magic, sizeof(magic), 1, f) == 1 && magic == WORLD_FILE_MAGIC;
+}
+
+bool open_world_file(const char *filepath, World_File *world)
+{
+    *world = {};
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filepath, GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        println(stderr, "Could not open file `", filepath, "`: error ", (uint64_t) GetLastError());
+        return false;
+    }
+    defer(CloseHandle(file));
+
+    LARGE_INTEGER size = {};
+    if (!GetFileSizeEx(file, &size)) {
+        println(stderr, "Could not stat file `", filepath, "`: error ", (uint64_t) GetLastError());
+        return false;
+    }
+
+    // NOTE: an empty file can not be mapped. It is rejected as too
+    // small below.
+    if (size.QuadPart > 0) {
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping == NULL) {
+            println(stderr, "Could not map file `", filepath, "`: error ", (uint64_t) GetLastError());
+            return false;
+        }
+        // NOTE: the view keeps the mapping alive after its handle is closed
+        defer(CloseHandle(mapping));
+
+        const void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (data == NULL) {
+            println(stderr, "Could not map file `", filepath, "`: error ", (uint64_t) GetLastError());
+            return false;
+        }
+
+        world->data = (const uint8_t*) data;
+        world->size = (size_t) size.QuadPart;
+        world->mapped = true;
+    }
+#else
+    int fd = open(filepath, O_RDONLY);
+    if (fd < 0) {
+        println(stderr, "Could not open file `", filepath, "`: ", strerror(errno));
+        return false;
+    }
+    defer(close(fd));
+
+    struct stat st = {};
+    if (fstat(fd, &st) < 0) {
+        println(stderr, "Could not stat file `", filepath, "`: ", strerror(errno));
+        return false;
+    }
+
+    if (st.st_size > 0) {
+        void *data = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            println(stderr, "Could not mmap file `", filepath, "`: ", strerror(errno));
+            return false;
+        }
+
+        world->data = (const uint8_t*) data;
+        world->size = (size_t) st.st_size;
+        world->mapped = true;
+    }
+#endif // _WIN32
+
+    if (world->size < sizeof(World_File_Header)) {
+        println(stderr, filepath, ": the file is too small to be a world file");
+        close_world_file(world);
+        return false;
+    }
+
+    world->header = (const World_File_Header*) world->data;
+    const auto header = world->header;
+    if (header->magic != WORLD_FILE_MAGIC) {
+        println(stderr, filepath, ": not a world file");
+        close_world_file(world);
+        return false;
+    }
+
+    if (header->version != WORLD_FILE_VERSION) {
+        println(stderr, filepath, ": unsupported world file version ", header->version,
+                ". Expected ", WORLD_FILE_VERSION);
+        close_world_file(world);
+        return false;
+    }
+
+    if (header->chunk_size != WORLD_CHUNK_SIZE ||
+        header->width == 0 || header->width > TILE_GRID_WIDTH ||
+        header->height == 0 || header->height > TILE_GRID_HEIGHT)
+    {
+        println(stderr, filepath, ": invalid world size ", header->width, "x", header->height,
+                " with chunks of ", header->chunk_size);
+        close_world_file(world);
+        return false;
+    }
+
+    world->chunks_width = (header->width + WORLD_CHUNK_SIZE - 1) / WORLD_CHUNK_SIZE;
+    world->chunks_height = (header->height + WORLD_CHUNK_SIZE - 1) / WORLD_CHUNK_SIZE;
+    const size_t chunks_count = world->chunks_width * world->chunks_height;
+    const size_t directory_end = sizeof(World_File_Header) + chunks_count * sizeof(World_File_Chunk);
+    if (world->size < directory_end) {
+        println(stderr, filepath, ": the chunk directory is truncated");
+        close_world_file(world);
+        return false;
+    }
+
+    world->chunks = (const World_File_Chunk*) (world->data + sizeof(World_File_Header));
+    for (size_t i = 0; i < chunks_count; ++i) {
+        const auto chunk = world->chunks[i];
+        if (chunk.size > 0 &&
+            (chunk.offset < directory_end || (uint64_t) chunk.offset + chunk.size > world->size))
+        {
+            println(stderr, filepath, ": chunk ", i, " is out of the file bounds");
+            close_world_file(world);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void close_world_file(World_File *world)
+{
+    if (world->data != NULL) {
+#ifdef _WIN32
+        if (world->mapped) {
+            UnmapViewOfFile(world->data);
+        }
+#else
+        if (world->mapped) {
+            munmap((void*) world->data, world->size);
+        }
+#endif // _WIN32
+    }
+    *world = {};
+}
+
+static size_t encode_world_chunk(const Tile *tiles, size_t stride,
+                                 size_t x0, size_t y0, size_t w, size_t h,
+                                 uint8_t *bytes)
+{
+    size_t size = 0;
+    const size_t n = w * h;
+    size_t i = 0;
+    while (i < n) {
+        const Tile tile = tiles[(y0 + i / w) * stride + x0 + i % w];
+        size_t length = 1;
+        while (i + length < n &&
+               tiles[(y0 + (i + length) / w) * stride + x0 + (i + length) % w] == tile)
+        {
+            length += 1;
+        }
+
+        // NOTE: the empty chunks are not stored at all
+        if (length == n && tile == TILE_EMPTY) {
+            return 0;
+        }
+
+        size += world_put_varint(bytes + size, (uint32_t) length);
+        size += world_put_varint(bytes + size, tile);
+        i += length;
+    }
+
+    assert(size <= WORLD_CHUNK_DATA_CAPACITY);
+    return size;
+}
+
+int save_world_file(const char *filepath, const Tile *tiles, size_t stride,
+                    size_t width, size_t height)
+{
+    assert(0 < width && width <= TILE_GRID_WIDTH);
+    assert(0 < height && height <= TILE_GRID_HEIGHT);
+
+    const size_t chunks_width = (width + WORLD_CHUNK_SIZE - 1) / WORLD_CHUNK_SIZE;
+    const size_t chunks_height = (height + WORLD_CHUNK_SIZE - 1) / WORLD_CHUNK_SIZE;
+    const size_t chunks_count = chunks_width * chunks_height;
+    assert(chunks_count <= WORLD_CHUNKS_CAPACITY);
+
+    // NOTE: the file is written next to the target and renamed over it
+    // only once it is complete, so a crash or a full disk in the middle
+    // of the save leaves the previous file intact
+    char tmp_filepath[1024];
+    if (snprintf(tmp_filepath, sizeof(tmp_filepath), "%s.tmp", filepath) >= (int) sizeof(tmp_filepath)) {
+        return ENAMETOOLONG;
+    }
+
+    FILE *f = fopen(tmp_filepath, "wb");
+    if (f == NULL) return errno;
+
+    // NOTE: not static. The world streaming thread saves rooms too.
+    World_File_Chunk *chunks = (World_File_Chunk*) calloc(chunks_count, sizeof(World_File_Chunk));
+    assert(chunks != NULL);
+    defer(free(chunks));
+    uint8_t *chunk_data = (uint8_t*) malloc(WORLD_CHUNK_DATA_CAPACITY);
+    assert(chunk_data != NULL);
+    defer(free(chunk_data));
+
+    World_File_Header header = {};
+    header.magic = WORLD_FILE_MAGIC;
+    header.version = WORLD_FILE_VERSION;
+    header.width = (uint32_t) width;
+    header.height = (uint32_t) height;
+    header.chunk_size = WORLD_CHUNK_SIZE;
+    fwrite(&header, sizeof(header), 1, f);
+    // NOTE: the directory is written again once the offsets are known
+    fwrite(chunks, sizeof(chunks[0]), chunks_count, f);
+
+    size_t offset = sizeof(header) + sizeof(chunks[0]) * chunks_count;
+    for (size_t cy = 0; cy < chunks_height; ++cy) {
+        for (size_t cx = 0; cx < chunks_width; ++cx) {
+            const size_t x0 = cx * WORLD_CHUNK_SIZE;
+            const size_t y0 = cy * WORLD_CHUNK_SIZE;
+            const size_t size = encode_world_chunk(
+                tiles, stride, x0, y0,
+                min(WORLD_CHUNK_SIZE, width - x0),
+                min(WORLD_CHUNK_SIZE, height - y0),
+                chunk_data);
+
+            if (size > 0) {
+                fwrite(chunk_data, 1, size, f);
+                chunks[cy * chunks_width + cx] = {(uint32_t) offset, (uint32_t) size};
+                offset += size;
+            }
+        }
+    }
+
+    fseek(f, sizeof(header), SEEK_SET);
+    fwrite(chunks, sizeof(chunks[0]), chunks_count, f);
+
+    // NOTE: the buffered writes may only fail on the flush
+    errno = 0;
+    const bool written = fflush(f) == 0 && !ferror(f);
+    int err = written ? 0 : (errno ? errno : EIO);
+    if (fclose(f) != 0 && err == 0) {
+        err = errno ? errno : EIO;
+    }
+    if (err != 0) {
+        remove(tmp_filepath);
+        return err;
+    }
+
+#ifdef _WIN32
+    if (!MoveFileExA(tmp_filepath, filepath, MOVEFILE_REPLACE_EXISTING)) {
+        remove(tmp_filepath);
+        return EIO;
+    }
+#else
+    if (rename(tmp_filepath, filepath) != 0) {
+        err = errno;
+        remove(tmp_filepath);
+        return err;
+    }
+#endif // _WIN32
+
+    return 0;
+}
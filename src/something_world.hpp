@@ -0,0 +1,71 @@
+#ifndef SOMETHING_WORLD_HPP_
+#define SOMETHING_WORLD_HPP_
+
+// NOTE: World file layout (little-endian):
+//
+//     World_File_Header
+//     World_File_Chunk[chunks_width * chunks_height]   -- row-major
+//     chunk data
+//
+// Every chunk is a square of WORLD_CHUNK_SIZE tiles (clipped by the
+// width and the height of the world) encoded row by row as runs of
+// (varint length, varint tile). A chunk of size 0 is all TILE_EMPTY
+// and has no data at all.
+
+const uint32_t WORLD_FILE_MAGIC = 0x444c5753; // "SWLD"
+const uint32_t WORLD_FILE_VERSION = 1;
+const size_t WORLD_CHUNK_SIZE = 64;
+const size_t WORLD_CHUNKS_CAPACITY =
+    (TILE_GRID_WIDTH / WORLD_CHUNK_SIZE) * (TILE_GRID_HEIGHT / WORLD_CHUNK_SIZE);
+// NOTE: the longest encoding of a chunk: a run of one for every tile
+// with both varints taking 5 bytes
+const size_t WORLD_CHUNK_DATA_CAPACITY = WORLD_CHUNK_SIZE * WORLD_CHUNK_SIZE * 10;
+
+struct World_File_Header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t chunk_size;
+};
+
+struct World_File_Chunk
+{
+    uint32_t offset;
+    uint32_t size;
+};
+
+struct World_File
+{
+    const uint8_t *data;
+    size_t size;
+    bool mapped;
+
+    const World_File_Header *header;
+    const World_File_Chunk *chunks;
+    size_t chunks_width;
+    size_t chunks_height;
+
+    // NOTE: decodes chunk (cx, cy) into dst, which points at the tile
+    // (0, 0) of the world and has `stride` tiles per row. Returns
+    // false if the chunk data is corrupted.
+    bool decode_chunk(size_t cx, size_t cy, Tile *dst, size_t stride) const;
+};
+
+bool is_world_file(const char *filepath);
+
+// NOTE: maps the file (mmap, MapViewOfFile on Windows) and validates
+// the header and the chunk directory. The chunks are decoded only by
+// World_File::decode_chunk. Returns false with the reason printed to
+// stderr.
+bool open_world_file(const char *filepath, World_File *world);
+void close_world_file(World_File *world);
+
+// NOTE: `tiles` points at the tile (0, 0) of the saved area and has
+// `stride` tiles per row. The file is replaced only once the new one
+// is completely written. Returns 0 on success or errno.
+int save_world_file(const char *filepath, const Tile *tiles, size_t stride,
+                    size_t width, size_t height);
+
+#endif  // SOMETHING_WORLD_HPP_
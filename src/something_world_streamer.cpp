@@ -0,0 +1,394 @@
+#include "./something_world_streamer.hpp"
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif // _WIN32
+
+Vec2i room_layout_coord(Vec2i slot)
+{
+    return vec2(slot.x * (ROOM_WIDTH + ROOM_LAYOUT_PADDING),
+                slot.y * (ROOM_HEIGHT + ROOM_LAYOUT_PADDING));
+}
+
+Vec2i room_layout_slot(Vec2i tile_coord)
+{
+    // NOTE: floor division, the player may be outside of the grid
+    const int w = ROOM_WIDTH + ROOM_LAYOUT_PADDING;
+    const int h = ROOM_HEIGHT + ROOM_LAYOUT_PADDING;
+    return vec2((tile_coord.x - (tile_coord.x < 0 ? w - 1 : 0)) / w,
+                (tile_coord.y - (tile_coord.y < 0 ? h - 1 : 0)) / h);
+}
+
+static bool is_room_slot_inbounds(Vec2i slot)
+{
+    return 0 <= slot.x && slot.x < ROOM_LAYOUT_WIDTH &&
+           0 <= slot.y && slot.y < ROOM_LAYOUT_HEIGHT;
+}
+
+static int room_slot_distance(Vec2i a, Vec2i b)
+{
+    return max(abs(a.x - b.x), abs(a.y - b.y));
+}
+
+static void room_save_path(const char *save_dir, Vec2i slot, char *path, size_t path_size)
+{
+    snprintf(path, path_size, "%sroom-%d-%d.bin", save_dir, slot.x, slot.y);
+}
+
+static void make_dir(const char *path)
+{
+#ifdef _WIN32
+    _mkdir(path);
+#else
+    mkdir(path, 0755);
+#endif // _WIN32
+}
+
+void remove_room_saves(const char *save_dir)
+{
+    DIR *dir = opendir(save_dir);
+    if (dir == NULL) return;
+    defer(closedir(dir));
+
+    char path[256];
+    for (struct dirent *d = readdir(dir); d != NULL; d = readdir(dir)) {
+        if (strncmp(d->d_name, "room-", 5) != 0) continue;
+        snprintf(path, sizeof(path), "%s%s", save_dir, d->d_name);
+        if (remove(path) != 0) {
+            println(stderr, "[ERROR] Could not remove `", path, "`: ", strerror(errno));
+        }
+    }
+}
+
+uint32_t load_world_seed(const char *save_dir, uint32_t new_seed)
+{
+    char path[256];
+    snprintf(path, sizeof(path), "%s%s", save_dir, WORLD_SEED_FILE_NAME);
+
+    FILE *f = fopen(path, "rb");
+    if (f != NULL) {
+        uint32_t seed = 0;
+        const bool ok = fread(&seed, sizeof(seed), 1, f) == 1;
+        fclose(f);
+        if (ok) return seed;
+        println(stderr, "[WARN] Could not read the world seed from `", path, "`, starting a new world");
+    }
+
+    // NOTE: the rooms saved without a seed belong to some other world
+    remove_room_saves(save_dir);
+    make_dir(save_dir);
+
+    f = fopen(path, "wb");
+    if (f == NULL || fwrite(&new_seed, sizeof(new_seed), 1, f) != 1) {
+        println(stderr, "[ERROR] Could not save the world seed to `", path, "`: ", strerror(errno));
+    }
+    if (f != NULL) fclose(f);
+
+    return new_seed;
+}
+
+void process_room_job(const char *save_dir, Room_Job *job)
+{
+    char path[256];
+    room_save_path(save_dir, job->slot, path, sizeof(path));
+
+    switch (job->kind) {
+    case Room_Job_Kind::Load: {
+        job->has_tiles = false;
+        if (is_world_file(path)) {
+            // NOTE: a broken save must not take the game down every
+            // time the player comes near its slot. The room falls back
+            // to its template and the file is moved aside, so it is
+            // neither read again nor lost.
+            job->has_tiles = read_world_room_file(path, job->tiles);
+            if (!job->has_tiles) {
+                char corrupted_path[256 + 16];
+                snprintf(corrupted_path, sizeof(corrupted_path), "%s.corrupted", path);
+                remove(corrupted_path);
+                if (rename(path, corrupted_path) == 0) {
+                    println(stderr, "[ERROR] Room save `", path, "` is corrupted. Moved it to `",
+                            corrupted_path, "` and used the template instead");
+                } else {
+                    println(stderr, "[ERROR] Room save `", path, "` is corrupted and could not be moved aside: ",
+                            strerror(errno));
+                }
+            }
+        }
+    } break;
+
+    case Room_Job_Kind::Save: {
+        const int err = save_world_file(path, &job->tiles[0][0], ROOM_WIDTH, ROOM_WIDTH, ROOM_HEIGHT);
+        if (err != 0) {
+            println(stderr, "[ERROR] Could not save room to `", path, "`: ", strerror(err));
+        }
+    } break;
+    }
+}
+
+static int world_streamer_thread(void *data)
+{
+    World_Streamer *streamer = (World_Streamer*) data;
+    profile_thread_name("World_Streamer");
+    Room_Job job = {};
+
+    while (true) {
+        SDL_SemWait(streamer->pending);
+
+        SDL_LockMutex(streamer->mutex);
+        if (streamer->requests.count == 0) {
+            const bool quit = streamer->quit;
+            SDL_UnlockMutex(streamer->mutex);
+            if (quit) break;
+            continue;
+        }
+        job = streamer->requests.dq();
+        SDL_UnlockMutex(streamer->mutex);
+
+        {
+            PROFILE_ZONE("Room Job");
+            process_room_job(streamer->save_dir, &job);
+        }
+
+        if (job.kind == Room_Job_Kind::Load) {
+            SDL_LockMutex(streamer->mutex);
+            streamer->results.nq(job);
+            SDL_UnlockMutex(streamer->mutex);
+        }
+    }
+
+    return 0;
+}
+
+void World_Streamer::start(Tile_Grid *grid, Dynamic_Array<Dynamic_Array<char>> room_files,
+                           uint32_t seed, const char *save_dir)
+{
+    if (room_files.size == 0) {
+        println(stderr, "[ERROR] No room files to build the world from");
+        abort();
+    }
+
+    if (room_files.size > WORLD_STREAMER_TEMPLATES_CAPACITY) {
+        println(stderr, "[ERROR] Too many room files. The limit is ", WORLD_STREAMER_TEMPLATES_CAPACITY);
+        abort();
+    }
+
+    // NOTE: the templates are small and few, so they are loaded up front
+    // and never evicted
+    templates_count = 0;
+    for (size_t i = 0; i < room_files.size; ++i) {
+        templates[templates_count++] = grid->load_room_template(room_files.data[i].data);
+    }
+    this->seed = seed;
+    this->save_dir = save_dir;
+
+    make_dir(WORLD_STREAMER_SAVE_DIR);
+    make_dir(save_dir);
+
+    mutex = SDL_CreateMutex();
+    if (mutex == NULL) {
+        println(stderr, "SDL pooped itself: Failed to create a mutex: ", SDL_GetError());
+        abort();
+    }
+
+    pending = SDL_CreateSemaphore(0);
+    if (pending == NULL) {
+        println(stderr, "SDL pooped itself: Failed to create a semaphore: ", SDL_GetError());
+        abort();
+    }
+
+    thread = SDL_CreateThread(world_streamer_thread, "World_Streamer", this);
+    if (thread == NULL) {
+        println(stderr, "SDL pooped itself: Failed to create a thread: ", SDL_GetError());
+        abort();
+    }
+}
+
+void World_Streamer::stop(Game *game)
+{
+    if (thread == NULL) return;
+
+    apply_results(game);
+    for (size_t i = 0; i < active_count;) {
+        if (slots[active[i].y][active[i].x] != Room_Slot_State::Loaded) {
+            ++i;
+        } else if (!evict(game, i)) {
+            // NOTE: the queue is full, waiting for the thread to save some rooms
+            SDL_Delay(1);
+        }
+    }
+
+    SDL_LockMutex(mutex);
+    quit = true;
+    SDL_UnlockMutex(mutex);
+    SDL_SemPost(pending);
+
+    SDL_WaitThread(thread, NULL);
+    thread = NULL;
+
+    SDL_DestroySemaphore(pending);
+    SDL_DestroyMutex(mutex);
+}
+
+Room_Template_Index World_Streamer::template_of_slot(Vec2i slot)
+{
+    // NOTE: the same slot always gets the same template, so an evicted
+    // room that was not modified comes back the same without being saved
+    uint32_t h = seed;
+    h ^= (uint32_t) slot.x * 0x9E3779B1u;
+    h = (h ^ (h >> 16)) * 0x85EBCA6Bu;
+    h ^= (uint32_t) slot.y * 0xC2B2AE35u;
+    h = (h ^ (h >> 13)) * 0x27D4EB2Fu;
+    h ^= h >> 16;
+    return templates[h % templates_count];
+}
+
+bool World_Streamer::request(const Room_Job *job)
+{
+    SDL_LockMutex(mutex);
+    // NOTE: every Load moves from requests to results, so keeping their
+    // sum under the capacity means the thread never overflows results
+    if (requests.count + results.count >= WORLD_STREAMER_QUEUE_CAPACITY) {
+        SDL_UnlockMutex(mutex);
+        return false;
+    }
+    requests.nq(*job);
+    SDL_UnlockMutex(mutex);
+
+    SDL_SemPost(pending);
+    return true;
+}
+
+void World_Streamer::apply_results(Game *game)
+{
+    Room_Job job = {};
+
+    while (true) {
+        SDL_LockMutex(mutex);
+        if (results.count == 0) {
+            SDL_UnlockMutex(mutex);
+            break;
+        }
+        job = results.dq();
+        SDL_UnlockMutex(mutex);
+
+        // NOTE: the slot was taken over by a restored snapshot while
+        // the room was loading
+        if (slots[job.slot.y][job.slot.x] != Room_Slot_State::Loading) continue;
+
+        const auto coord = room_layout_coord(job.slot);
+        if (job.has_tiles) {
+            for (int dy = 0; dy < ROOM_HEIGHT; ++dy) {
+                for (int dx = 0; dx < ROOM_WIDTH; ++dx) {
+                    game->grid.set_tile(vec2(coord.x + dx, coord.y + dy), job.tiles[dy][dx]);
+                }
+            }
+        } else {
+            game->grid.instance_room(template_of_slot(job.slot), coord);
+        }
+
+        game->add_camera_lock(rect(coord, ROOM_WIDTH, ROOM_HEIGHT));
+        slots[job.slot.y][job.slot.x] = Room_Slot_State::Loaded;
+    }
+}
+
+bool World_Streamer::evict(Game *game, size_t active_index)
+{
+    assert(active_index < active_count);
+    const Vec2i slot = active[active_index];
+    if (slots[slot.y][slot.x] != Room_Slot_State::Loaded) return false;
+
+    Room_Job job = {};
+    job.kind = Room_Job_Kind::Save;
+    job.slot = slot;
+    job.has_tiles = true;
+
+    const auto coord = room_layout_coord(slot);
+    // NOTE: the save must be queued before the room leaves the grid.
+    // If the queue is full the eviction is retried on the next update.
+    SDL_LockMutex(mutex);
+    const bool has_room = requests.count + results.count < WORLD_STREAMER_QUEUE_CAPACITY;
+    SDL_UnlockMutex(mutex);
+    if (!has_room) return false;
+
+    if (game->grid.evict_room(coord, job.tiles)) {
+        const bool requested = request(&job);
+        assert(requested);
+    }
+
+    game->remove_camera_lock(rect(coord, ROOM_WIDTH, ROOM_HEIGHT));
+    slots[slot.y][slot.x] = Room_Slot_State::Unloaded;
+    active[active_index] = active[--active_count];
+    return true;
+}
+
+void World_Streamer::update(Game *game, Vec2f player_pos)
+{
+    PROFILE_ZONE("World_Streamer::update");
+    apply_results(game);
+
+    const Vec2i center = room_layout_slot(game->grid.abs_to_tile_coord(player_pos));
+    // NOTE: the gap between the radii keeps the rooms on the border of
+    // the ring from being reloaded every time the player steps back
+    const int evict_radius = max(STREAMING_EVICT_RADIUS, STREAMING_LOAD_RADIUS + 1);
+
+    for (size_t i = 0; i < active_count;) {
+        if (room_slot_distance(active[i], center) > evict_radius && evict(game, i)) {
+            continue;
+        }
+        ++i;
+    }
+
+    request_ring(center);
+    if (synchronous) {
+        wait_loading(game);
+    }
+}
+
+void World_Streamer::request_ring(Vec2i center)
+{
+    // NOTE: closest rooms first, so the room the player is entering is
+    // the first one to arrive
+    Room_Job job = {};
+    job.kind = Room_Job_Kind::Load;
+    for (int r = 0; r <= STREAMING_LOAD_RADIUS; ++r) {
+        for (int dy = -r; dy <= r; ++dy) {
+            for (int dx = -r; dx <= r; ++dx) {
+                if (max(abs(dx), abs(dy)) != r) continue;
+
+                const Vec2i slot = vec2(center.x + dx, center.y + dy);
+                if (!is_room_slot_inbounds(slot)) continue;
+                if (slots[slot.y][slot.x] != Room_Slot_State::Unloaded) continue;
+                if (active_count >= WORLD_STREAMER_ACTIVE_CAPACITY) return;
+
+                job.slot = slot;
+                if (!request(&job)) return;
+
+                slots[slot.y][slot.x] = Room_Slot_State::Loading;
+                active[active_count++] = slot;
+            }
+        }
+    }
+}
+
+void World_Streamer::load_now(Game *game, Vec2f player_pos)
+{
+    update(game, player_pos);
+    wait_loading(game);
+}
+
+void World_Streamer::wait_loading(Game *game)
+{
+    while (true) {
+        apply_results(game);
+
+        bool loading = false;
+        for (size_t i = 0; i < active_count && !loading; ++i) {
+            loading = slots[active[i].y][active[i].x] == Room_Slot_State::Loading;
+        }
+        if (!loading) break;
+
+        SDL_Delay(1);
+    }
+}
@@ -0,0 +1,100 @@
+#ifndef SOMETHING_WORLD_STREAMER_HPP_
+#define SOMETHING_WORLD_STREAMER_HPP_
+
+// NOTE: the world is a lattice of rooms separated by a column/row of
+// empty tiles. The lattice covers the whole Tile_Grid.
+const int ROOM_LAYOUT_PADDING = 1;
+const int ROOM_LAYOUT_WIDTH = ((int) TILE_GRID_WIDTH + ROOM_LAYOUT_PADDING) / (ROOM_WIDTH + ROOM_LAYOUT_PADDING);
+const int ROOM_LAYOUT_HEIGHT = ((int) TILE_GRID_HEIGHT + ROOM_LAYOUT_PADDING) / (ROOM_HEIGHT + ROOM_LAYOUT_PADDING);
+
+Vec2i room_layout_coord(Vec2i slot);
+Vec2i room_layout_slot(Vec2i tile_coord);
+
+const char *const WORLD_STREAMER_SAVE_DIR = "./saves/";
+// NOTE: the rooms in the save dir are deltas of the world generated
+// from this seed, so it lives next to them
+const char *const WORLD_SEED_FILE_NAME = "world.seed";
+const size_t WORLD_STREAMER_QUEUE_CAPACITY = 256;
+const size_t WORLD_STREAMER_TEMPLATES_CAPACITY = ROOM_TEMPLATES_CAPACITY;
+// NOTE: every loaded room has a camera lock
+const size_t WORLD_STREAMER_ACTIVE_CAPACITY = CAMERA_LOCKS_CAPACITY;
+
+enum class Room_Slot_State: uint8_t
+{
+    Unloaded = 0,
+    Loading,
+    Loaded,
+};
+
+enum class Room_Job_Kind
+{
+    Load,
+    Save,
+};
+
+struct Room_Job
+{
+    Room_Job_Kind kind;
+    Vec2i slot;
+    // NOTE: Save: the tiles to save. Load: the saved tiles if has_tiles,
+    // otherwise the room was never modified and is instanced from its
+    // template.
+    bool has_tiles;
+    Tile tiles[ROOM_HEIGHT][ROOM_WIDTH];
+};
+
+// NOTE: keeps the rooms within STREAMING_LOAD_RADIUS of the player's
+// room loaded and unloads the ones further than STREAMING_EVICT_RADIUS.
+// The rooms that were modified are saved to save_dir on
+// eviction and loaded back from there. All of the file IO happens on a
+// background thread. The grid and the camera locks are only touched by
+// the main thread in update().
+struct World_Streamer
+{
+    SDL_Thread *thread;
+    SDL_mutex *mutex;
+    SDL_sem *pending;
+    bool quit;
+
+    Queue<Room_Job, WORLD_STREAMER_QUEUE_CAPACITY> requests;
+    Queue<Room_Job, WORLD_STREAMER_QUEUE_CAPACITY> results;
+
+    Room_Slot_State slots[ROOM_LAYOUT_HEIGHT][ROOM_LAYOUT_WIDTH];
+    // NOTE: the slots that are Loading or Loaded
+    Vec2i active[WORLD_STREAMER_ACTIVE_CAPACITY];
+    size_t active_count;
+    Room_Template_Index templates[WORLD_STREAMER_TEMPLATES_CAPACITY];
+    size_t templates_count;
+    uint32_t seed;
+    const char *save_dir;
+    // NOTE: update() waits for the rooms it requested, so the rooms
+    // arrive on the same simulation tick on every run. Used by the input
+    // recording and replay.
+    bool synchronous;
+
+    void start(Tile_Grid *grid, Dynamic_Array<Dynamic_Array<char>> room_files,
+               uint32_t seed, const char *save_dir);
+    // NOTE: saves all of the loaded modified rooms and stops the thread
+    void stop(Game *game);
+
+    void update(Game *game, Vec2f player_pos);
+    // NOTE: blocks until the ring around player_pos is loaded. Used
+    // before the first frame so the player does not fall through the
+    // rooms that are not loaded yet.
+    void load_now(Game *game, Vec2f player_pos);
+    void wait_loading(Game *game);
+
+    Room_Template_Index template_of_slot(Vec2i slot);
+    bool request(const Room_Job *job);
+    void request_ring(Vec2i center);
+    void apply_results(Game *game);
+    bool evict(Game *game, size_t active_index);
+};
+
+void process_room_job(const char *save_dir, Room_Job *job);
+void remove_room_saves(const char *save_dir);
+// NOTE: the seed of the world saved in `save_dir`. Starts a new world
+// with `new_seed` if there is none.
+uint32_t load_world_seed(const char *save_dir, uint32_t new_seed);
+
+#endif  // SOMETHING_WORLD_STREAMER_HPP_